@@ -38,25 +38,485 @@
 #include <fstream>
 #include <iomanip>
 #include <limits>
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <map>
+#include <typeinfo>
+#include <cxxabi.h>
+#include <set>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <climits>
 #include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <malloc.h>
+#include <unistd.h>
 
 using namespace ns3;
 
 
-//start a single experiment 
-void experiment (bool enableCtsRts, uint16_t NumofNode, uint16_t DurationofSimulation, double FirstNodeLoad, double RestNodeLoad)
+//one point of the (FirstNodeLoad, RestNodeLoad) sweep
+struct SweepPoint
+{
+  uint32_t index;         // position of the point in the serial sweep order
+  uint32_t run;           // RngRun of a replication, 0 for the single run of the default RngRun
+  double firstNodeLoad;
+  double restNodeLoad;
+};
+
+
+//number of decimals naming a load: two for the grid points, as many as needed for the loads found by the adaptive modes
+int LoadDigits (double load)
+{
+  int digits = 2;
+  while (digits < 6 && std::fabs (load * std::pow (10.0, digits) - std::floor (load * std::pow (10.0, digits) + 0.5)) > 1e-6)
+    {
+      ++digits;
+    }
+  return digits;
+}
+
+
+//directory holding the athstats files of one sweep point
+std::string PointDirectory (std::string const &outputRoot, double FirstNodeLoad, double RestNodeLoad)
+{
+  char pathname [256];
+  snprintf (pathname, sizeof (pathname), "%s/u_0=%.*frho=%.*f", outputRoot.c_str (),
+            LoadDigits (FirstNodeLoad), FirstNodeLoad, LoadDigits (RestNodeLoad), RestNodeLoad);
+  return pathname;
+}
+
+
+//root of the sweep point folders of one replication
+std::string ReplicationRoot (std::string const &outputRoot, uint32_t run)
+{
+  if (run == 0)
+    {
+      return outputRoot;
+    }
+  char pathname [256];
+  snprintf (pathname, sizeof (pathname), "%s/run_%03u", outputRoot.c_str (), run);
+  return pathname;
+}
+
+
+//optional behaviour of an experiment; the defaults run the fixed-length simulation
+struct ExperimentOptions
+{
+  ExperimentOptions ()
+    : ciPrecision (0),
+      ciBatches (20),
+      snapshot (false),
+      crn (false),
+      splitFactor (4),
+      frontUtilization (0.5),
+      frontWindow (10),
+      rampStep (0.02),
+      rampDwell (0),
+      rampSettle (10),
+      progressInterval (0),
+      progressStderr (false),
+      reuse (false),
+      profile (false),
+      neighbours (false),
+      linkCache (false),
+      culling (0),
+      perTable (0)
+  {
+  }
+
+  double ciPrecision;               // relative half-width at which the run stops (0 runs DurationofSimulation seconds)
+  uint32_t ciBatches;               // number of batch means in the confidence intervals
+  std::vector<uint32_t> ciNodes;    // sender nodes whose utilization and throughput are monitored (empty: all senders)
+  bool snapshot;                    // fork the points of a sweep from one simulation of their common warm-up
+  bool crn;                         // common random numbers: pin every random stream but the attacker's
+  std::vector<uint32_t> levels;     // splitting: senders the cascade front crosses, towards node 0 (empty disables splitting)
+  uint32_t splitFactor;             // splitting: copies of a trajectory crossing a level
+  double frontUtilization;          // splitting: utilization of a sender reached by the cascade front
+  uint32_t frontWindow;             // splitting: reports averaged into the utilization compared with frontUtilization
+  double rampStep;                  // ramp: attacker load step
+  uint32_t rampDwell;               // ramp: seconds spent at each attacker load (0 keeps FirstNodeLoad for the whole run)
+  uint32_t rampSettle;              // ramp: leading seconds of each step left out of its statistics
+  double progressInterval;          // wall seconds between two progress reports (0 disables them)
+  bool progressStderr;              // print the progress reports to stderr as well
+  std::string statusFile;           // file receiving the progress of the experiment, set by the sweep runner
+  bool reuse;                       // run the points of a sweep one after the other on a single chain, reset in between
+  bool profile;                     // time every event with ProfilingSimulatorImpl and write profile.txt
+  bool neighbours;                  // deliver each frame only to the channel neighbours of its sender
+  bool linkCache;                   // compute the delay and rx power of every link once
+  double culling;                   // dB below the noise floor under which a phy ignores a signal (0 disables culling)
+  double perTable;                  // largest error of the chunk success rates read from lookup tables (0 disables them)
+};
+
+
+//two-sided 95% quantile of the Student t distribution
+double StudentT95 (uint32_t dof)
+{
+  static const double table[] = { 12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+                                  2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+                                  2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042 };
+  if (dof == 0)
+    {
+      return std::numeric_limits<double>::infinity ();
+    }
+  if (dof <= 30)
+    {
+      return table[dof - 1];
+    }
+  return 1.960 + 2.4 / dof;
+}
+
+
+/*
+ * Stops the simulation once every monitored series is known precisely enough.
+ *
+ * At each check the rows a series has written past the MSER cut-off of its
+ * sender are split into a fixed number of batches, and the 95% confidence
+ * interval of the mean is built from the batch means. The run stops when the
+ * half-width of every interval is at most the requested fraction of its mean.
+ * Means close to zero, as those of the victims after the cascade, would never
+ * meet a relative precision, so the precision is measured against at least 1%
+ * of the channel capacity. The Simulator::Stop of the experiment remains the
+ * hard cap on the run length.
+ */
+class RunLengthController
+{
+public:
+  RunLengthController (double precision, uint32_t batches, Time checkInterval);
+  ~RunLengthController ();
+
+  /**
+   * Monitor the utilization of a sender and the throughput of its receiver.
+   */
+  void Monitor (uint32_t sender, Ptr<AthstatsWifiTraceSink> senderSink, Ptr<AthstatsWifiTraceSink> receiverSink);
+
+  /**
+   * Check the series every checkInterval from now on.
+   *
+   * @param start the simulated time at which the experiment began
+   */
+  void Start (Time start);
+  bool IsConverged (void) const;
+
+  /**
+   * Write the stop time and the interval of every series:
+   *   <stop seconds> <converged>
+   *   <node> <utilization|throughput> <mean> <half-width> <rows>
+   */
+  void Write (std::string const &filename) const;
+
+private:
+  struct Series
+  {
+    uint32_t node;
+    std::string name;
+    Ptr<AthstatsWifiTraceSink> warmupSink;
+    Ptr<AthstatsWifiTraceSink> sink;
+    bool throughput;
+    double floor;
+    double mean;
+    double halfWidth;
+    uint32_t rows;
+  };
+
+  /**
+   * Update the batch-means interval of a series.
+   * Returns true when the series has enough rows and meets the precision.
+   */
+  bool Estimate (Series &series) const;
+  void Check (void);
+
+  double m_precision;
+  uint32_t m_batches;
+  Time m_checkInterval;
+  std::vector<Series> m_series;
+  bool m_converged;
+  Time m_start;
+  EventId m_event;
+};
+
+RunLengthController::RunLengthController (double precision, uint32_t batches, Time checkInterval)
+  : m_precision (precision),
+    m_batches (batches),
+    m_checkInterval (checkInterval),
+    m_converged (false)
+{
+}
+
+RunLengthController::~RunLengthController ()
+{
+  Simulator::Cancel (m_event);
+}
+
+void
+RunLengthController::Monitor (uint32_t sender, Ptr<AthstatsWifiTraceSink> senderSink, Ptr<AthstatsWifiTraceSink> receiverSink)
+{
+  Series series;
+  series.node = sender;
+  series.warmupSink = senderSink;
+  series.mean = 0;
+  series.halfWidth = std::numeric_limits<double>::infinity ();
+  series.rows = 0;
+
+  series.name = "utilization";
+  series.sink = senderSink;
+  series.throughput = false;
+  series.floor = 0.01;
+  m_series.push_back (series);
+
+  series.name = "throughput";
+  series.sink = receiverSink;
+  series.throughput = true;
+  series.floor = 0.01 * 1000000 / 8 * receiverSink->GetInterval ().GetSeconds ();   // bytes per row at 1% of 1 Mbps
+  m_series.push_back (series);
+}
+
+void
+RunLengthController::Start (Time start)
+{
+  m_start = start;
+  m_event = Simulator::Schedule (m_checkInterval, &RunLengthController::Check, this);
+}
+
+bool
+RunLengthController::IsConverged (void) const
+{
+  return m_converged;
+}
+
+bool
+RunLengthController::Estimate (Series &series) const
+{
+  std::vector<double> const &values = series.throughput ? series.sink->GetRxBytesSeries () : series.sink->GetUtilizationSeries ();
+  uint32_t cutoff = series.warmupSink->GetWarmupRows ();
+  if (!series.warmupSink->IsWarmupDetected () || values.size () <= cutoff)
+    {
+      return false;
+    }
+  series.rows = values.size () - cutoff;
+  uint32_t batchSize = series.rows / m_batches;
+  if (m_batches < 2 || batchSize < 2)
+    {
+      return false;
+    }
+
+  // the most recent m_batches * batchSize rows, away from the cut-off
+  size_t first = values.size () - m_batches * batchSize;
+  std::vector<double> means (m_batches, 0);
+  for (uint32_t b = 0; b < m_batches; ++b)
+    {
+      for (uint32_t k = 0; k < batchSize; ++k)
+        {
+          means[b] += values[first + b * batchSize + k];
+        }
+      means[b] /= batchSize;
+    }
+  double mean = 0;
+  for (uint32_t b = 0; b < m_batches; ++b)
+    {
+      mean += means[b];
+    }
+  mean /= m_batches;
+  double variance = 0;
+  for (uint32_t b = 0; b < m_batches; ++b)
+    {
+      variance += (means[b] - mean) * (means[b] - mean);
+    }
+  variance /= m_batches - 1;
+
+  series.mean = mean;
+  series.halfWidth = StudentT95 (m_batches - 1) * std::sqrt (variance / m_batches);
+  return series.halfWidth <= m_precision * std::max (std::fabs (mean), series.floor);
+}
+
+void
+RunLengthController::Check (void)
+{
+  bool converged = !m_series.empty ();
+  for (size_t i = 0; i < m_series.size (); ++i)
+    {
+      converged = Estimate (m_series[i]) && converged;
+    }
+  if (converged)
+    {
+      m_converged = true;
+      std::cout << " confidence intervals met at " << (Simulator::Now () - m_start).GetSeconds () << " s" << std::endl;
+      Simulator::Stop ();
+      return;
+    }
+  m_event = Simulator::Schedule (m_checkInterval, &RunLengthController::Check, this);
+}
+
+void
+RunLengthController::Write (std::string const &filename) const
+{
+  std::ofstream out (filename.c_str ());
+  out << (Simulator::Now () - m_start).GetSeconds () << " " << (m_converged ? 1 : 0) << std::endl;
+  for (size_t i = 0; i < m_series.size (); ++i)
+    {
+      out << m_series[i].node << " " << m_series[i].name << " " << m_series[i].mean << " "
+          << m_series[i].halfWidth << " " << m_series[i].rows << std::endl;
+    }
+}
+
+
+//version of the simulated model in the COMPLETE manifests: bump it by hand with any change to the
+//chain, the PHY/MAC drop-ins or the statistics that alters the results, so that cached points are simulated again
+const uint32_t modelVersion = 2;
+
+
+/*
+ * Streams pinned by the common random numbers mode, the same at every sweep
+ * point, so that neighbouring points only differ by the attacker's traffic.
+ * From crnStream on, each block starting where the previous one ends:
+ *   phy, station manager and MAC of each device, in node order
+ *   internet stack of each node, in node order
+ *   OnTime and OffTime of each background sender, two per sender
+ * The attacker keeps its automatically assigned streams.
+ */
+const int64_t crnStream = 0;
+
+//first stream of the trajectories forked by the splitting mode, each one taking splitStreamStride streams,
+//the trajectory with id k starting at splitStream + k * splitStreamStride, below reuseStream
+const int64_t splitStream = 100000;
+const int64_t splitStreamStride = 1000;
+
+//first stream of the points run on a reused chain, each one taking the streams counted by ReseedChain ()
+const int64_t reuseStream = 1000000000;
+
+//simulated seconds a reused chain is left idle between two points, for the frames in flight to end
+const double reuseDrain = 2;
+
+
+//the objects of a chain that the phases of an experiment following its construction act on;
+//it holds every object the experiment creates, and TeardownChain () releases them
+struct Chain
+{
+  NodeContainer nodes;
+  NetDeviceContainer devices;
+  Ipv4InterfaceContainer interfaces;
+  ApplicationContainer senders;     // OnOff application of each sender, the attacker last
+  ApplicationContainer sinks;       // PacketSink of each receiver
+  ApplicationContainer pings;       // UdpEchoClient of each sender, resolving ARP
+  AthstatsHelper athstats;
+  Time start;                       // simulated time at which the current experiment began, 0 unless the chain is reused
+  int64_t crnSenderStream;          // first pinned stream of the background senders with CRN (AssignCrnStreams)
+};
+
+
+//pin the streams of the devices and internet stacks of a chain for CRN, and return the first stream of the
+//background senders, which take two each; all the blocks must end below the splitting streams
+int64_t AssignCrnStreams (Chain &chain)
+{
+  int64_t stream = crnStream;
+  stream += WifiHelper::AssignStreams (chain.devices, stream);
+  InternetStackHelper internet;
+  stream += internet.AssignStreams (chain.nodes, stream);
+  NS_ABORT_MSG_IF (stream + 2 * (int64_t)(chain.nodes.GetN ()/2) > splitStream,
+                   "AssignCrnStreams: the pinned streams of " << chain.nodes.GetN () << " nodes run into the splitting streams");
+  return stream;
+}
+
+
+//set the OnTime and OffTime of an OnOffHelper or OnOffApplication generating Poisson traffic at the given load
+template <typename T>
+void SetOnOffLoad (T &onoff, double load)
 {
-  // 0. Enable or disable CTS/RTS
-  UintegerValue ctsThr = (enableCtsRts ? UintegerValue (100) : UintegerValue (10000000));
-  Config::SetDefault ("ns3::WifiRemoteStationManager::RtsCtsThreshold", ctsThr);
-  Config::SetDefault ("ns3::WifiNetDevice::Mtu", UintegerValue(2296));
+  if (load == 1){
+    onoff.SetAttribute ("OnTime",  StringValue ("ns3::ConstantRandomVariable[Constant=1]"));
+    onoff.SetAttribute ("OffTime", StringValue ("ns3::ConstantRandomVariable[Constant=0]"));
+  }else if (load == 0){
+    onoff.SetAttribute ("OnTime",  StringValue ("ns3::ConstantRandomVariable[Constant=0]"));
+    onoff.SetAttribute ("OffTime", StringValue ("ns3::ConstantRandomVariable[Constant=1]"));
+  }else {
+    std::stringstream ontime;
+    std::stringstream offtime;
+    double pkt_time = (double)1/1000000*1500*8;
+    ontime << "ns3::ConstantRandomVariable[Constant=" << pkt_time << "]";
+    onoff.SetAttribute ("OnTime",  StringValue (ontime.str()));
+    offtime << "ns3::ExponentialRandomVariable[Mean=" << 1/(load*(1/pkt_time))-pkt_time << "]";
+    onoff.SetAttribute ("OffTime", StringValue (offtime.str()));
+  }
+}
+
+
+//first port of the CBR flows, the receiver of sender i listening on cbrPort + i
+const uint16_t cbrPort = 12345;
+
+//install the senders of a chain, the attacker last, and the single packets of its ARP warm-up, all of them
+//starting at the same offsets from now as in a new chain
+void InstallTraffic (Chain &chain, double FirstNodeLoad, double RestNodeLoad, bool crn)
+{
+  uint32_t pairs = chain.nodes.GetN ()/2;
+  for (size_t i = 0; i < pairs; ++i){
+    //set nodes as senders
+    OnOffHelper onoffhelper ("ns3::UdpSocketFactory", InetSocketAddress (chain.interfaces.GetAddress (i*2+1), cbrPort+i));
+    onoffhelper.SetAttribute ("PacketSize", UintegerValue (1500));
+    if ( i == pairs-1 ){
+      SetOnOffLoad (onoffhelper, FirstNodeLoad);
+    }else{
+      SetOnOffLoad (onoffhelper, RestNodeLoad);
+    }
+    onoffhelper.SetAttribute ("DataRate", StringValue ("1000000bps"));
+    onoffhelper.SetAttribute ("StartTime", TimeValue (Seconds (3.100+i*0.01)));
+    ApplicationContainer sender = onoffhelper.Install (chain.nodes.Get (i*2));
+    if (crn && i != pairs-1){
+      DynamicCast<OnOffApplication> (sender.Get (0))->AssignStreams (chain.crnSenderStream + 2*i);
+    }
+    chain.senders.Add (sender);
+  }
+ 
+
+   /** \internal
+     * We also use separate UDP applications that will send a single
+     * packet before the CBR flows start.
+     * This is a workaround for the lack of perfect ARP, see \bugid{187}
+     */
+
+  uint16_t  echoPort = 9;
+  // again using different start times to workaround Bug 388 and Bug 912
+  for (size_t i = 0; i < pairs; ++i){
+    UdpEchoClientHelper echoClientHelper (chain.interfaces.GetAddress (i*2+1), echoPort);
+    echoClientHelper.SetAttribute ("MaxPackets", UintegerValue (1));
+    echoClientHelper.SetAttribute ("Interval", TimeValue (Seconds (100000.0)));
+    echoClientHelper.SetAttribute ("PacketSize", UintegerValue (10));
+    echoClientHelper.SetAttribute ("StartTime", TimeValue (Seconds (0.001+i/1000)));
+    chain.pings.Add (echoClientHelper.Install (chain.nodes.Get (i*2)));
+  }
+}
+
 
+//attribute defaults set by every experiment, as (attribute, value) pairs
+std::vector<std::pair<std::string, std::string> > ExperimentDefaults (bool enableCtsRts)
+{
+  std::vector<std::pair<std::string, std::string> > defaults;
+  defaults.push_back (std::make_pair ("ns3::WifiRemoteStationManager::RtsCtsThreshold", enableCtsRts ? "100" : "10000000"));
+  defaults.push_back (std::make_pair ("ns3::WifiNetDevice::Mtu", "2296"));
   /**Static ARP setup**/
-  Config::SetDefault ("ns3::ArpCache::DeadTimeout", TimeValue (Seconds (0)));
-  Config::SetDefault ("ns3::ArpCache::AliveTimeout", TimeValue (Seconds (120000)));
+  defaults.push_back (std::make_pair ("ns3::ArpCache::DeadTimeout", "0s"));
+  defaults.push_back (std::make_pair ("ns3::ArpCache::AliveTimeout", "120000s"));
+  return defaults;
+}
+
+
+//build the chain of nodes with its applications, up to the start of the simulation
+void BuildChain (bool enableCtsRts, uint16_t NumofNode, double FirstNodeLoad, double RestNodeLoad, Chain &chain,
+                 ExperimentOptions const &options)
+{
+  // 0. Enable or disable CTS/RTS, static ARP setup
+  std::vector<std::pair<std::string, std::string> > defaults = ExperimentDefaults (enableCtsRts);
+  for (size_t i = 0; i < defaults.size (); ++i){
+    Config::SetDefault (defaults[i].first, StringValue (defaults[i].second));
+  }
 
   // 1. Create nodes 
-  NodeContainer nodes;
+  NodeContainer &nodes = chain.nodes;
   nodes.Create (NumofNode);
 
   // 2. Create network topology using matrix propagation loss matrix
@@ -76,7 +536,19 @@ void experiment (bool enableCtsRts, uint16_t NumofNode, uint16_t DurationofSimul
   // 3. Create & setup wifi channel
   Ptr<YansWifiChannel> wifiChannel = CreateObject <YansWifiChannel> ();
   wifiChannel->SetPropagationLossModel (lossModel);
+  // every node stays at the origin, so the delay is zero: a frame starts to
+  // keep the receivers' CCA busy at the instant it is sent, which leaves no
+  // lookahead for a conservative parallel simulation of chain segments
   wifiChannel->SetPropagationDelayModel (CreateObject <ConstantSpeedPropagationDelayModel> ());
+  // a node only hears its two neighbours in the chain, every other pair is
+  // 150 dB apart: skip the receptions far below the noise floor
+  if (options.neighbours){
+    wifiChannel->SetAttribute ("NeighbourLists", BooleanValue (true));
+  }
+  // the nodes never move and the loss matrix is fixed
+  if (options.linkCache){
+    wifiChannel->SetAttribute ("LinkCache", BooleanValue (true));
+  }
 
   // 4. Install wireless devices
   /*constant rate wifi manager*/
@@ -89,127 +561,2750 @@ void experiment (bool enableCtsRts, uint16_t NumofNode, uint16_t DurationofSimul
                                 "MaxSlrc", UintegerValue(7));
   YansWifiPhyHelper wifiPhy =  YansWifiPhyHelper::Default ();
   wifiPhy.SetChannel (wifiChannel);
+  if (options.culling > 0){
+    wifiPhy.Set ("CullingThreshold", DoubleValue (options.culling));
+  }
+  if (options.perTable > 0){
+    wifiPhy.Set ("PerTableTolerance", DoubleValue (options.perTable));
+  }
 	
   NqosWifiMacHelper wifiMac = NqosWifiMacHelper::Default ();
   wifiMac.SetType ("ns3::AdhocWifiMac"); // use ad-hoc MAC
-  NetDeviceContainer devices = wifi.Install (wifiPhy, wifiMac, nodes);	
+  NetDeviceContainer &devices = chain.devices;
+  devices = wifi.Install (wifiPhy, wifiMac, nodes);	
 
   // 5. Install IP stack & assign IP addresses
   InternetStackHelper internet;
   internet.Install (nodes);
   Ipv4AddressHelper ipv4;
   ipv4.SetBase ("10.0.0.0", "255.0.0.0");
-  ipv4.Assign (devices);
+  chain.interfaces = ipv4.Assign (devices);
+  if (options.crn){
+    chain.crnSenderStream = AssignCrnStreams (chain);
+  }
 
   // 6. Install applications: Install applications: the UDP packets are generated by Poisson traffic
-  ApplicationContainer cbrApps;
-  uint16_t cbrPort = 12345;
-  std::vector<OnOffHelper*> onoffhelpers;
-  std::vector<PacketSinkHelper*> sinks;
-
   for (size_t i = 0; i < (NumofNode/2); ++i){
-    //set nodes as senders
-    std::stringstream ipv4address;
-    std::stringstream offtime_first;
-    std::stringstream offtime_rest;
-    ipv4address << "10.0.0." << (i*2+2);
-    OnOffHelper *onoffhelper = new OnOffHelper("ns3::UdpSocketFactory", InetSocketAddress (Ipv4Address (ipv4address.str().c_str()), cbrPort+i));
-    onoffhelper->SetAttribute ("PacketSize", UintegerValue (1500));
-    if ( i == (uint16_t)(NumofNode/2-1) ){
-      if (FirstNodeLoad == 1){
-        onoffhelper->SetAttribute ("OnTime",  StringValue ("ns3::ConstantRandomVariable[Constant=1]"));
-        onoffhelper->SetAttribute ("OffTime", StringValue ("ns3::ConstantRandomVariable[Constant=0]"));
-      }else if (FirstNodeLoad == 0){
-        onoffhelper->SetAttribute ("OnTime",  StringValue ("ns3::ConstantRandomVariable[Constant=0]"));
-        onoffhelper->SetAttribute ("OffTime", StringValue ("ns3::ConstantRandomVariable[Constant=1]"));	
-      }else {
-        std::stringstream ontime_first;
-        double pkt_time_first = (double)1/1000000*1500*8;
-        ontime_first << "ns3::ConstantRandomVariable[Constant=" << pkt_time_first << "]";
-        onoffhelper->SetAttribute ("OnTime",  StringValue (ontime_first.str()));
-        offtime_first << "ns3::ExponentialRandomVariable[Mean=" << 1/(FirstNodeLoad*(1/pkt_time_first))-pkt_time_first << "]";
-        onoffhelper->SetAttribute ("OffTime", StringValue (offtime_first.str()));
-      } 
-      onoffhelper->SetAttribute ("DataRate", StringValue ("1000000bps"));
-    }else{
-      std::stringstream ontime_rest;
-      double pkt_time_rest = (double)1/1000000*1500*8;
-      ontime_rest << "ns3::ConstantRandomVariable[Constant=" << pkt_time_rest << "]";
-      onoffhelper->SetAttribute ("OnTime",  StringValue (ontime_rest.str()));
-      offtime_rest << "ns3::ExponentialRandomVariable[Mean=" << 1/(RestNodeLoad*(1/pkt_time_rest))-pkt_time_rest << "]";
-      onoffhelper->SetAttribute ("OffTime", StringValue (offtime_rest.str()));
-      onoffhelper->SetAttribute ("DataRate", StringValue ("1000000bps"));
-    }
-    onoffhelper->SetAttribute ("StartTime", TimeValue (Seconds (3.100+i*0.01)));
-    cbrApps.Add (onoffhelper->Install (nodes.Get (i*2)));
-    onoffhelpers.push_back(onoffhelper);
-
     //set nodes as receivers
-    PacketSinkHelper *sink = new PacketSinkHelper("ns3::UdpSocketFactory",Address(InetSocketAddress (Ipv4Address::GetAny (), cbrPort+i)));
-    cbrApps.Add (sink->Install (nodes.Get(i*2+1)));
+    PacketSinkHelper sink ("ns3::UdpSocketFactory", Address (InetSocketAddress (Ipv4Address::GetAny (), cbrPort+i)));
+    chain.sinks.Add (sink.Install (nodes.Get(i*2+1)));
   }
- 
+  InstallTraffic (chain, FirstNodeLoad, RestNodeLoad, options.crn);
+}
 
-   /** \internal
-     * We also use separate UDP applications that will send a single
-     * packet before the CBR flows start.
-     * This is a workaround for the lack of perfect ARP, see \bugid{187}
-     */
 
-  std::vector<UdpEchoClientHelper*> echoClientHelpers;
-  uint16_t  echoPort = 9;
-  ApplicationContainer pingApps;
-  // again using different start times to workaround Bug 388 and Bug 912
-  for (size_t i = 0; i < (NumofNode/2); ++i){
-    std::stringstream ipv4address;
-    ipv4address << "10.0.0." << (i*2+2);
-    UdpEchoClientHelper *echoClientHelper = new UdpEchoClientHelper(Ipv4Address(ipv4address.str().c_str()), echoPort);
-    echoClientHelper->SetAttribute ("MaxPackets", UintegerValue (1));
-    echoClientHelper->SetAttribute ("Interval", TimeValue (Seconds (100000.0)));
-    echoClientHelper->SetAttribute ("PacketSize", UintegerValue (10));
-    echoClientHelper->SetAttribute ("StartTime", TimeValue (Seconds (0.001+i/1000)));
-    pingApps.Add (echoClientHelper->Install (nodes.Get (i*2)));
-    echoClientHelpers.push_back(echoClientHelper);
+//tear an experiment down: destroy the simulator, which disposes the nodes of
+//the node list with their devices and applications, then drop the references
+//of the chain so that they are freed, and the sinks close their files
+void TeardownChain (Chain &chain)
+{
+  Simulator::Destroy ();
+  chain.pings = ApplicationContainer ();
+  chain.sinks = ApplicationContainer ();
+  chain.senders = ApplicationContainer ();
+  chain.interfaces = Ipv4InterfaceContainer ();
+  chain.devices = NetDeviceContainer ();
+  chain.nodes = NodeContainer ();
+  chain.athstats = AthstatsHelper ();
+  // hand the freed heap back to the system, so that the RSS after an experiment shows what it left behind
+  malloc_trim (0);
+}
+
+
+//set the loads of the senders of a chain, the attacker being the last one
+void SetChainLoads (Chain &chain, double FirstNodeLoad, double RestNodeLoad)
+{
+  for (uint32_t i = 0; i < chain.senders.GetN (); ++i){
+    bool attacker = (i == chain.senders.GetN () - 1);
+    SetOnOffLoad (*chain.senders.Get (i), attacker ? FirstNodeLoad : RestNodeLoad);
   }
+}
 
-	
 
-  // 7. Install FlowMonitor on all nodes
-  mkdir("CDoS-1Mbps-adhoc-UDP-01",S_IRWXU | S_IRWXG | S_IRWXO);
-  char pathname [50];
-  std::stringstream filename;
-  std::stringstream foldername;
-  sprintf (pathname, "./CDoS-1Mbps-adhoc-UDP-01/u_0=%.2frho=%.2f",FirstNodeLoad, RestNodeLoad);
-  foldername << pathname;
-  filename << pathname << "/nodes";
-  mkdir(foldername.str().c_str(),S_IRWXU | S_IRWXG | S_IRWXO);
-  AthstatsHelper athstats;
-  athstats.EnableAthstats (filename.str().c_str(), devices);
+//give the random variables of a chain the streams from stream on, the pinned ones excepted with CRN;
+//returns the number of streams taken
+int64_t ReseedChain (Chain &chain, int64_t stream, bool crn)
+{
+  int64_t first = stream;
+  InternetStackHelper internet;
+  if (crn){
+    chain.crnSenderStream = AssignCrnStreams (chain);
+  }else {
+    stream += WifiHelper::AssignStreams (chain.devices, stream);
+    stream += internet.AssignStreams (chain.nodes, stream);
+  }
+  for (uint32_t i = 0; i < chain.senders.GetN (); ++i){
+    Ptr<OnOffApplication> sender = DynamicCast<OnOffApplication> (chain.senders.Get (i));
+    if (crn && i != chain.senders.GetN () - 1){
+      sender->AssignStreams (chain.crnSenderStream + 2*i);
+    }else {
+      stream += sender->AssignStreams (stream);
+    }
+  }
+  return stream - first;
+}
+
+
+/*
+ * Culling report of one experiment, one line per node:
+ *   <node> <culled signals> <worst-case SINR error (dB)>
+ * followed by "all" with the total and the largest error.
+ */
+void WriteCullingReport (std::string const &filename, Chain &chain)
+{
+  std::ofstream out (filename.c_str ());
+  uint64_t total = 0;
+  double worst = 0;
+  for (uint32_t i = 0; i < chain.devices.GetN (); ++i){
+    Ptr<YansWifiPhy> phy = DynamicCast<YansWifiPhy> (DynamicCast<WifiNetDevice> (chain.devices.Get (i))->GetPhy ());
+    out << i << " " << phy->GetNCulledSignals () << " " << phy->GetCullingErrorBound () << std::endl;
+    total += phy->GetNCulledSignals ();
+    worst = std::max (worst, phy->GetCullingErrorBound ());
+  }
+  out << "all " << total << " " << worst << std::endl;
+}
+
+
+//drop the frames waiting in the MAC queues of a chain
+void FlushMacQueues (Chain &chain)
+{
+  for (uint32_t i = 0; i < chain.devices.GetN (); ++i){
+    PointerValue dca;
+    DynamicCast<WifiNetDevice> (chain.devices.Get (i))->GetMac ()->GetAttribute ("DcaTxop", dca);
+    dca.Get<DcaTxop> ()->GetQueue ()->Flush ();
+  }
+}
+
+
+//silence the senders of a chain for good: they stay off far longer than any run, so that they never send again
+void SilenceSenders (Chain &chain)
+{
+  for (uint32_t i = 0; i < chain.senders.GetN (); ++i){
+    chain.senders.Get (i)->SetAttribute ("OnTime",  StringValue ("ns3::ConstantRandomVariable[Constant=0]"));
+    chain.senders.Get (i)->SetAttribute ("OffTime", StringValue ("ns3::ConstantRandomVariable[Constant=1e9]"));
+  }
+}
+
+
+//put the contention window of every DCF back to its minimum and forget the remote stations,
+//as in a new chain; the backoffs have run out while the chain idled
+void ResetMacState (Chain &chain)
+{
+  for (uint32_t i = 0; i < chain.devices.GetN (); ++i){
+    Ptr<WifiNetDevice> device = DynamicCast<WifiNetDevice> (chain.devices.Get (i));
+    PointerValue dca;
+    device->GetMac ()->GetAttribute ("DcaTxop", dca);
+    // setting CWmin resets the contention window
+    dca.Get<DcaTxop> ()->SetMinCw (dca.Get<DcaTxop> ()->GetMinCw ());
+    device->GetRemoteStationManager ()->Reset ();
+  }
+}
 
-  // 8. Run simulation
-  Simulator::Stop (Seconds (DurationofSimulation));
+
+//empty the ARP caches of a chain, which the warm-up of the next experiment fills again
+void FlushArpCaches (Chain &chain)
+{
+  for (uint32_t i = 0; i < chain.nodes.GetN (); ++i){
+    Ptr<Ipv4L3Protocol> ipv4 = chain.nodes.Get (i)->GetObject<Ipv4L3Protocol> ();
+    for (uint32_t j = 0; j < ipv4->GetNInterfaces (); ++j){
+      Ptr<ArpCache> arpCache = ipv4->GetInterface (j)->GetArpCache ();
+      if (arpCache != 0){
+        arpCache->Flush ();
+      }
+    }
+  }
+}
+
+
+/*
+ * Reset the dynamic state of a chain between two experiments, keeping its
+ * nodes, devices, loss matrix and IP stack. The reports of the last
+ * experiment are finished, the senders are silenced for good and the MAC
+ * queues flushed, and the chain idles until every frame in flight has ended,
+ * which also clears the PHY and lets the backoffs run out. The contention
+ * windows, remote stations and ARP caches are then reset, and the next
+ * experiment starts on a whole second, so that the reports keep their
+ * one-second rows, with fresh reports in foldername and new senders and ARP
+ * warm-up packets at the given loads, started at the offsets of a new chain.
+ * The MAC sequence numbers and UDP source ports still go on from the last
+ * experiment. Its random streams are left to the caller (ReseedChain).
+ */
+void ResetChain (Chain &chain, double FirstNodeLoad, double RestNodeLoad, std::string const &foldername, bool crn)
+{
+  chain.athstats.Restart ("");
+  SilenceSenders (chain);
+  FlushMacQueues (chain);
+  Simulator::Stop (Seconds (std::ceil (Simulator::Now ().GetSeconds ()) + reuseDrain) - Simulator::Now ());
   Simulator::Run ();
+  FlushMacQueues (chain);
+  ResetMacState (chain);
+  FlushArpCaches (chain);
+  for (uint32_t i = 0; i < chain.devices.GetN (); ++i){
+    DynamicCast<YansWifiPhy> (DynamicCast<WifiNetDevice> (chain.devices.Get (i))->GetPhy ())->ResetCulling ();
+  }
+  chain.start = Simulator::Now ();
+  chain.senders = ApplicationContainer ();
+  InstallTraffic (chain, FirstNodeLoad, RestNodeLoad, crn);
+  chain.athstats.Restart (foldername + "/nodes");
+}
 
-  // 9. Cleanup
-  Simulator::Destroy ();
+
+/*
+ * Fixed multilevel splitting of the cascade onset.
+ *
+ * Level j is crossed once the utilization of sender levels[j], averaged over
+ * the last frontWindow reports, reaches frontUtilization. A trajectory
+ * crossing a level forks splitFactor - 1 clones with fresh random streams,
+ * and it and its clones carry each 1/splitFactor of its weight. The clones run
+ * one after the other while the trajectory waits (depth first), so at most
+ * one process per level is alive. A trajectory ends after the last level or
+ * at the end of the run, and appends "<levels crossed> <weight> <end seconds>"
+ * to the results file with a single write, which the clones of every root
+ * share. The weights of the trajectories that crossed level j sum to an
+ * unbiased estimate of the probability of crossing it within the run.
+ */
+class SplittingController
+{
+public:
+  SplittingController (Chain &chain, ExperimentOptions const &options);
+
+  /**
+   * Start watching the levels, the results being appended to filename.
+   */
+  void Start (std::string const &filename);
+
+  /**
+   * @return true in the processes forked by a split
+   */
+  bool IsClone (void) const;
+
+  /**
+   * Append the end of this trajectory to the results file.
+   */
+  void Finish (void) const;
+
+private:
+  bool IsCrossed (uint32_t level) const;
+  void Split (void);
+  void Reseed (void);
+  void Check (void);
+
+  Chain &m_chain;
+  std::vector<uint32_t> m_levels;
+  uint32_t m_splitFactor;
+  double m_frontUtilization;
+  uint32_t m_frontWindow;
+  std::string m_filename;
+  uint32_t m_crossed;
+  double m_weight;
+  uint64_t m_id;
+  bool m_clone;
+};
+
+SplittingController::SplittingController (Chain &chain, ExperimentOptions const &options)
+  : m_chain (chain),
+    m_levels (options.levels),
+    m_splitFactor (std::max<uint32_t> (options.splitFactor, 1)),
+    m_frontUtilization (options.frontUtilization),
+    m_frontWindow (std::max<uint32_t> (options.frontWindow, 1)),
+    m_crossed (0),
+    m_weight (1),
+    m_id (1),
+    m_clone (false)
+{
 }
 
+void
+SplittingController::Start (std::string const &filename)
+{
+  m_filename = filename;
+  Simulator::Schedule (Seconds (1), &SplittingController::Check, this);
+}
 
+bool
+SplittingController::IsClone (void) const
+{
+  return m_clone;
+}
 
-int main (int argc, char **argv){
-  //Packet::EnablePrinting ();
-  RngSeedManager::SetSeed(1);
-  uint16_t numofnode = 82;
-  uint16_t durationofsimulation = 1003;
-  double firstnodeload;
-  double restnodeload;
+bool
+SplittingController::IsCrossed (uint32_t level) const
+{
+  std::vector<double> const &utilization = m_chain.athstats.GetSink (m_levels[level], 0)->GetUtilizationSeries ();
+  if (utilization.size () < m_frontWindow)
+    {
+      return false;
+    }
+  double sum = 0;
+  for (size_t k = utilization.size () - m_frontWindow; k < utilization.size (); ++k)
+    {
+      sum += utilization[k];
+    }
+  return sum / m_frontWindow >= m_frontUtilization;
+}
+
+void
+SplittingController::Reseed (void)
+{
+  int64_t stream = splitStream + m_id * splitStreamStride;
+  stream += WifiHelper::AssignStreams (m_chain.devices, stream);
+  InternetStackHelper internet;
+  stream += internet.AssignStreams (m_chain.nodes, stream);
+  for (uint32_t i = 0; i < m_chain.senders.GetN (); ++i)
+    {
+      stream += DynamicCast<OnOffApplication> (m_chain.senders.Get (i))->AssignStreams (stream);
+    }
+  NS_ABORT_MSG_IF (stream > splitStream + (int64_t)(m_id + 1) * splitStreamStride,
+                   "SplittingController: a trajectory needs more than " << splitStreamStride << " streams");
+}
+
+void
+SplittingController::Split (void)
+{
+  m_weight /= m_splitFactor;
+  // heap numbering from a root of 1: the children of p are p * f + r, r < f,
+  // which are unique over the whole tree; the parent continues as r = 0
+  uint64_t parent = m_id;
+  NS_ABORT_MSG_IF (parent >= (uint64_t)((reuseStream - splitStream) / splitStreamStride) / m_splitFactor,
+                   "SplittingController: too many levels for the stream budget of the trajectories");
+  m_id = parent * m_splitFactor;
+  for (uint32_t r = 1; r < m_splitFactor; ++r)
+    {
+      m_chain.athstats.Flush ();
+      std::cout.flush ();
+      pid_t pid = fork ();
+      NS_ABORT_MSG_IF (pid < 0, "SplittingController: fork () failed");
+      if (pid == 0)
+        {
+          m_id = parent * m_splitFactor + r;
+          m_clone = true;
+          m_chain.athstats.Detach ();
+          Reseed ();
+          return;
+        }
+      int status;
+      waitpid (pid, &status, 0);
+      NS_ABORT_MSG_UNLESS (WIFEXITED (status) && WEXITSTATUS (status) == 0, "SplittingController: clone failed");
+    }
+}
+
+void
+SplittingController::Check (void)
+{
+  while (m_crossed < m_levels.size () && IsCrossed (m_crossed))
+    {
+      ++m_crossed;
+      if (m_crossed < m_levels.size ())
+        {
+          Split ();
+        }
+    }
+  if (m_crossed == m_levels.size ())
+    {
+      Simulator::Stop ();
+      return;
+    }
+  Simulator::Schedule (Seconds (1), &SplittingController::Check, this);
+}
+
+void
+SplittingController::Finish (void) const
+{
+  char line [128];
+  int length = snprintf (line, sizeof (line), "%u %.17g %f\n", m_crossed, m_weight, Simulator::Now ().GetSeconds ());
+  int fd = open (m_filename.c_str (), O_WRONLY | O_APPEND | O_CREAT, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+  NS_ABORT_MSG_IF (fd < 0, "SplittingController: cannot open " << m_filename);
+  ssize_t written = write (fd, line, length);
+  close (fd);
+  NS_ABORT_MSG_UNLESS (written == length, "SplittingController: cannot write " << m_filename);
+}
+
+
+//attacker loads of the ramp: up from rampStep to 1 - rampStep, then back down
+std::vector<double> RampLoads (double rampStep)
+{
+  std::vector<double> loads;
+  uint32_t steps = (uint32_t)(1 / rampStep + 0.5) - 1;
+  for (uint32_t k = 1; k <= steps; ++k)
+    {
+      loads.push_back (k * rampStep);
+    }
+  for (uint32_t k = steps - 1; k >= 1; --k)
+    {
+      loads.push_back (k * rampStep);
+    }
+  return loads;
+}
+
+//time of the first step of the ramp, the first whole second after the attacker starts
+double RampStart (uint16_t NumofNode)
+{
+  return std::ceil (3.100 + (NumofNode/2-1)*0.01);
+}
+
+//length of a run going once up and down the ramp
+uint32_t RampDuration (uint16_t NumofNode, double rampStep, uint32_t rampDwell)
+{
+  double duration = RampStart (NumofNode) + (double)RampLoads (rampStep).size () * rampDwell;
+  NS_ABORT_MSG_IF (duration > std::numeric_limits<uint32_t>::max (),
+                   "RampDuration: a ramp of " << duration << " s is too long, raise --rampStep or lower --rampDwell");
+  return (uint32_t)duration;
+}
+
+//move the attacker to the next load of the ramp, and the athstats reports to a new segment
+void SetRampLoad (Chain *chain, double load, std::string label, uint32_t settleRows)
+{
+  SetOnOffLoad (*chain->senders.Get (chain->senders.GetN () - 1), load);
+  chain->athstats.StartSegment (label, settleRows);
+}
+
+
+//wall-clock seconds since an arbitrary origin
+double WallClockSeconds (void)
+{
+  struct timespec ts;
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+
+//a field of /proc/self/status, in kB
+uint64_t StatusKilobytes (std::string const &name)
+{
+  std::ifstream in ("/proc/self/status");
+  std::string field;
+  while (in >> field)
+    {
+      if (field == name)
+        {
+          uint64_t kilobytes = 0;
+          in >> kilobytes;
+          return kilobytes;
+        }
+      in.ignore (std::numeric_limits<std::streamsize>::max (), '\n');
+    }
+  return 0;
+}
+
+
+//resident set size of this process, in kB
+uint64_t ResidentKilobytes (void)
+{
+  return StatusKilobytes ("VmRSS:");
+}
+
+
+//peak resident set size of this process since the last ResetPeakResident (), in kB
+uint64_t PeakResidentKilobytes (void)
+{
+  return StatusKilobytes ("VmHWM:");
+}
+
+
+//reset the peak resident set size to the current one; kernels before 4.0
+//ignore it, and the peak is then that of the whole process
+void ResetPeakResident (void)
+{
+  int fd = open ("/proc/self/clear_refs", O_WRONLY);
+  if (fd >= 0)
+    {
+      ssize_t written = write (fd, "5", 1);
+      (void) written;
+      close (fd);
+    }
+}
+
+
+/*
+ * Reports the progress of one experiment every interval of wall time, by
+ * rewriting its status file with one line:
+ *   <simulated seconds> <duration> <events> <events per wall second> <RSS kB> <wall seconds> <ETA seconds>
+ * The events are counted by the uids the simulator gives to scheduled events,
+ * and the rates and the ETA are those of the last interval. The sweep runner
+ * gathers the status files of its workers into status.txt.
+ */
+class ProgressReporter
+{
+public:
+  ProgressReporter (std::string const &statusFile, double interval, bool print, uint32_t DurationofSimulation);
+  ~ProgressReporter ();
+
+  /**
+   * @param start the simulated time at which the experiment began
+   */
+  void Start (Time start);
+
+private:
+  void Check (void);
+
+  std::string m_statusFile;
+  double m_interval;
+  bool m_print;
+  double m_duration;
+  Time m_start;
+  EventId m_event;
+  double m_wallStart;
+  double m_lastWall;
+  double m_lastSimulated;
+  uint64_t m_lastEvents;
+};
+
+ProgressReporter::ProgressReporter (std::string const &statusFile, double interval, bool print, uint32_t DurationofSimulation)
+  : m_statusFile (statusFile),
+    m_interval (interval),
+    m_print (print),
+    m_duration (DurationofSimulation),
+    m_wallStart (0),
+    m_lastWall (0),
+    m_lastSimulated (0),
+    m_lastEvents (0)
+{
+}
+
+ProgressReporter::~ProgressReporter ()
+{
+  Simulator::Cancel (m_event);
+}
+
+void
+ProgressReporter::Start (Time start)
+{
+  m_start = start;
+  m_wallStart = WallClockSeconds ();
+  m_lastWall = m_wallStart;
+  m_lastSimulated = (Simulator::Now () - m_start).GetSeconds ();
+  m_event = Simulator::Schedule (MilliSeconds (100), &ProgressReporter::Check, this);
+}
+
+void
+ProgressReporter::Check (void)
+{
+  m_event = Simulator::Schedule (MilliSeconds (100), &ProgressReporter::Check, this);
+  double wall = WallClockSeconds ();
+  if (wall - m_lastWall < m_interval)
+    {
+      return;
+    }
+  double simulated = (Simulator::Now () - m_start).GetSeconds ();
+  uint64_t events = m_event.GetUid ();
+  double eventRate = (events - m_lastEvents) / (wall - m_lastWall);
+  double eta = (m_duration - simulated) * (wall - m_lastWall) / std::max (simulated - m_lastSimulated, 1e-9);
+  char line [256];
+  snprintf (line, sizeof (line), "%.1f %.0f %llu %.0f %llu %.1f %.0f\n", simulated, m_duration, (unsigned long long) events,
+            eventRate, (unsigned long long) ResidentKilobytes (), wall - m_wallStart, eta);
+  std::string temporary = m_statusFile + ".tmp";
+  {
+    std::ofstream out (temporary.c_str ());
+    out << line;
+  }
+  rename (temporary.c_str (), m_statusFile.c_str ());
+  if (m_print)
+    {
+      std::cerr << " " << simulated << "/" << m_duration << " s simulated, " << eventRate << " events/s, RSS "
+                << ResidentKilobytes () / 1024 << " MB, ETA " << eta << " s" << std::endl;
+    }
+  m_lastWall = wall;
+  m_lastSimulated = simulated;
+  m_lastEvents = events;
+}
+
+
+//readable name of a type, without the ns3:: qualifiers
+std::string DemangledName (std::type_info const &type)
+{
+  int status = 0;
+  char *demangled = abi::__cxa_demangle (type.name (), 0, 0, &status);
+  std::string name = (status == 0 && demangled != 0) ? demangled : type.name ();
+  free (demangled);
+  for (size_t at = name.find ("ns3::"); at != std::string::npos; at = name.find ("ns3::", at))
+    {
+      name.erase (at, 5);
+    }
+  return name;
+}
+
+
+/*
+ * Simulator implementation timing every event it runs. Each scheduled event
+ * is wrapped into a ProfiledEvent, which measures the wall time of the
+ * handler and charges it, with one event, to the pair (handler, context).
+ * The handler is identified by the type of its event, i.e. the signature of
+ * the function and the class of the object it is called on: two member
+ * functions of a class with the same signature are merged. The context is
+ * the id of the node the event runs on. Trace sinks are charged to the event
+ * firing the trace. Select it before the first use of the simulator with
+ *   GlobalValue::Bind ("SimulatorImplementationType", StringValue ("ProfilingSimulatorImpl"));
+ */
+class ProfilingSimulatorImpl : public DefaultSimulatorImpl
+{
+public:
+  static TypeId GetTypeId (void);
+
+  virtual EventId Schedule (Time const &delay, EventImpl *event);
+  virtual void ScheduleWithContext (uint32_t context, Time const &delay, EventImpl *event);
+  virtual EventId ScheduleNow (EventImpl *event);
+
+  /**
+   * Charge the wall time of an event to its handler and context.
+   */
+  void Record (std::type_info const &handler, uint32_t context, double seconds);
+
+  /**
+   * Write the events and wall time of every handler, over all nodes and
+   * then per node, most expensive first, and start counting anew:
+   *   <wall seconds> <share of the wall time in %> <events> <microseconds per event> <node|all> <handler>
+   * The node of events without context is "-".
+   */
+  void Write (std::string const &filename);
+
+private:
+  struct Cost
+  {
+    Cost () : events (0), seconds (0) {}
+    uint64_t events;
+    double seconds;
+  };
+  typedef std::map<std::pair<std::type_info const *, uint32_t>, Cost> CostMap;
+
+  CostMap m_costs;
+};
+
+//scheduled event timed by ProfilingSimulatorImpl, owning the event it wraps
+class ProfiledEvent : public EventImpl
+{
+public:
+  ProfiledEvent (EventImpl *event, ProfilingSimulatorImpl *profiler)
+    : m_event (event),
+      m_profiler (profiler)
+  {
+  }
+  virtual ~ProfiledEvent ()
+  {
+    m_event->Unref ();
+  }
+
+protected:
+  virtual void Notify (void)
+  {
+    double start = WallClockSeconds ();
+    m_event->Invoke ();
+    m_profiler->Record (typeid (*m_event), Simulator::GetContext (), WallClockSeconds () - start);
+  }
+
+private:
+  EventImpl *m_event;
+  ProfilingSimulatorImpl *m_profiler;
+};
+
+NS_OBJECT_ENSURE_REGISTERED (ProfilingSimulatorImpl);
+
+TypeId
+ProfilingSimulatorImpl::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ProfilingSimulatorImpl")
+    .SetParent<DefaultSimulatorImpl> ()
+    .AddConstructor<ProfilingSimulatorImpl> ()
+  ;
+  return tid;
+}
+
+EventId
+ProfilingSimulatorImpl::Schedule (Time const &delay, EventImpl *event)
+{
+  return DefaultSimulatorImpl::Schedule (delay, new ProfiledEvent (event, this));
+}
+
+void
+ProfilingSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay, EventImpl *event)
+{
+  DefaultSimulatorImpl::ScheduleWithContext (context, delay, new ProfiledEvent (event, this));
+}
+
+EventId
+ProfilingSimulatorImpl::ScheduleNow (EventImpl *event)
+{
+  return DefaultSimulatorImpl::ScheduleNow (new ProfiledEvent (event, this));
+}
+
+void
+ProfilingSimulatorImpl::Record (std::type_info const &handler, uint32_t context, double seconds)
+{
+  Cost &cost = m_costs[std::make_pair (&handler, context)];
+  ++cost.events;
+  cost.seconds += seconds;
+}
+
+void
+ProfilingSimulatorImpl::Write (std::string const &filename)
+{
+  std::map<std::type_info const *, Cost> handlers;
+  double total = 0;
+  for (CostMap::const_iterator it = m_costs.begin (); it != m_costs.end (); ++it)
+    {
+      Cost &cost = handlers[it->first.first];
+      cost.events += it->second.events;
+      cost.seconds += it->second.seconds;
+      total += it->second.seconds;
+    }
+  // sorted by decreasing wall time, the lines over all nodes first
+  std::vector<std::pair<double, std::string> > lines;
+  char line [128];
+  for (std::map<std::type_info const *, Cost>::const_iterator it = handlers.begin (); it != handlers.end (); ++it)
+    {
+      snprintf (line, sizeof (line), "%.6f %.2f %llu %.3f all ", it->second.seconds, 100 * it->second.seconds / std::max (total, 1e-9),
+                (unsigned long long) it->second.events, 1e6 * it->second.seconds / it->second.events);
+      lines.push_back (std::make_pair (-it->second.seconds - total, line + DemangledName (*it->first)));
+    }
+  for (CostMap::const_iterator it = m_costs.begin (); it != m_costs.end (); ++it)
+    {
+      snprintf (line, sizeof (line), "%.6f %.2f %llu %.3f ", it->second.seconds, 100 * it->second.seconds / std::max (total, 1e-9),
+                (unsigned long long) it->second.events, 1e6 * it->second.seconds / it->second.events);
+      std::ostringstream node;
+      if (it->first.second == 0xffffffff)
+        {
+          node << "- ";
+        }
+      else
+        {
+          node << it->first.second << " ";
+        }
+      lines.push_back (std::make_pair (-it->second.seconds, line + node.str () + DemangledName (*it->first.first)));
+    }
+  std::sort (lines.begin (), lines.end ());
+  std::ofstream out (filename.c_str ());
+  for (size_t k = 0; k < lines.size (); ++k)
+    {
+      out << lines[k].second << std::endl;
+    }
+  m_costs.clear ();
+}
+
+
+//create the folder of a sweep point; returns it
+std::string MakePointDirectory (std::string const &outputRoot, double FirstNodeLoad, double RestNodeLoad)
+{
+  mkdir(outputRoot.c_str (),S_IRWXU | S_IRWXG | S_IRWXO);
+  std::string foldername = PointDirectory (outputRoot, FirstNodeLoad, RestNodeLoad);
+  mkdir(foldername.c_str(),S_IRWXU | S_IRWXG | S_IRWXO);
+  return foldername;
+}
+
+
+//run the chain until DurationofSimulation, or earlier once the confidence intervals are met
+void RunChain (Chain &chain, uint32_t DurationofSimulation, std::string const &foldername, ExperimentOptions const &options)
+{
+  uint16_t NumofNode = chain.nodes.GetN ();
+  AthstatsHelper &athstats = chain.athstats;
+  std::string runLengthFile = foldername + "/runlength.txt";
+  RunLengthController runLength (options.ciPrecision, options.ciBatches, Seconds (10));
+  if (options.ciPrecision > 0)
+    {
+      for (size_t i = 0; i < (NumofNode/2); ++i)
+        {
+          if (options.ciNodes.empty () || std::find (options.ciNodes.begin (), options.ciNodes.end (), i*2) != options.ciNodes.end ())
+            {
+              runLength.Monitor (i*2, athstats.GetSink (i*2, 0), athstats.GetSink (i*2+1, 0));
+            }
+        }
+      runLength.Start (chain.start);
+    }
+  else
+    {
+      unlink (runLengthFile.c_str ());
+    }
+  if (options.rampDwell > 0)
+    {
+      std::vector<double> loads = RampLoads (options.rampStep);
+      uint32_t up = (loads.size () + 1) / 2;
+      for (uint32_t k = 0; k < loads.size (); ++k)
+        {
+          char label [32];
+          snprintf (label, sizeof (label), "%.4f %s", loads[k], k < up ? "up" : "down");
+          Simulator::Schedule (Seconds (RampStart (NumofNode) + k * options.rampDwell) - Simulator::Now (),
+                               &SetRampLoad, &chain, loads[k], std::string (label), options.rampSettle);
+        }
+    }
+  ProgressReporter progress (options.statusFile, options.progressInterval, options.progressStderr, DurationofSimulation);
+  if (options.progressInterval > 0 && !options.statusFile.empty ())
+    {
+      progress.Start (chain.start);
+    }
+  std::string splittingFile = foldername + "/splitting.txt";
+  SplittingController splitting (chain, options);
+  unlink (splittingFile.c_str ());
+  if (!options.levels.empty ())
+    {
+      splitting.Start (splittingFile);
+    }
+  Simulator::Stop (chain.start + Seconds (DurationofSimulation) - Simulator::Now ());
+  Simulator::Run ();
+  if (!options.levels.empty ())
+    {
+      splitting.Finish ();
+      if (splitting.IsClone ())
+        {
+          std::cout.flush ();
+          _exit (0);
+        }
+    }
+  if (options.ciPrecision > 0)
+    {
+      runLength.Write (runLengthFile);
+    }
+  if (options.culling > 0)
+    {
+      WriteCullingReport (foldername + "/culling.txt", chain);
+    }
+  Ptr<ProfilingSimulatorImpl> profiler = DynamicCast<ProfilingSimulatorImpl> (Simulator::GetImplementation ());
+  if (profiler != 0)
+    {
+      profiler->Write (foldername + "/profile.txt");
+    }
+}
+
+
+/*
+ * Memory report of one experiment, in kB:
+ *   <RSS before> <peak RSS> <RSS after> <residual>
+ * The residual is the RSS after the teardown less the one before the build;
+ * it stays about zero from one experiment to the next when the experiment
+ * releases everything it creates.
+ */
+void WriteMemoryReport (std::string const &filename, uint64_t before, uint64_t peak, uint64_t after)
+{
+  std::ofstream out (filename.c_str ());
+  out << before << " " << peak << " " << after << " " << (int64_t)(after - before) << std::endl;
+}
+
+
+/*
+ * An experiment runs on the process-wide state of ns-3.22: the Simulator
+ * singleton, the NodeList, the Config root, the RngSeedManager seed, run and
+ * stream counter, and the TypeId registry. Ptr reference counts are not
+ * atomic either, so two experiments cannot run on threads of one process,
+ * even on read-only shared objects such as a loss matrix. The sweep runner
+ * runs them in forked processes instead. A worker shares the pages of its
+ * parent copy-on-write, and with snapshots that includes the chain built
+ * by the parent, so each worker only adds the memory its own point writes.
+ */
+
+
+//start a single experiment 
+void experiment (bool enableCtsRts, uint16_t NumofNode, uint32_t DurationofSimulation, double FirstNodeLoad, double RestNodeLoad,
+                 std::string const &outputRoot = "./CDoS-1Mbps-adhoc-UDP-01",
+                 ExperimentOptions const &options = ExperimentOptions ())
+{
+  uint64_t before = ResidentKilobytes ();
+  ResetPeakResident ();
+
+  // 0.-6. Build the chain
+  Chain chain;
+  BuildChain (enableCtsRts, NumofNode, FirstNodeLoad, RestNodeLoad, chain, options);
+
+  // 7. Install FlowMonitor on all nodes
+  std::string foldername = MakePointDirectory (outputRoot, FirstNodeLoad, RestNodeLoad);
+  chain.athstats.EnableAthstats (foldername + "/nodes", chain.devices);
+
+  // 8. Run simulation, at most DurationofSimulation seconds
+  RunChain (chain, DurationofSimulation, foldername, options);
+
+  // 9. Cleanup
+  uint64_t peak = PeakResidentKilobytes ();
+  TeardownChain (chain);
+  WriteMemoryReport (foldername + "/memory.txt", before, peak, ResidentKilobytes ());
+}
+
+
+
+/*
+ * Random variables that are not given an explicit stream take the next index
+ * of a process-wide counter that Simulator::Destroy () does not reset, so in
+ * the serial loop the k-th experiment draws from the streams following those
+ * of the first k-1 experiments. Every experiment creates the same objects, so
+ * it consumes a fixed number of stream indices; a worker process reproduces
+ * the serial results of point k by skipping k times that number.
+ *
+ * The count is measured in a throw-away child process that builds the chain
+ * and runs it past the start of the last application, so the parent never
+ * touches the global counter before forking the workers.
+ */
+uint64_t ProbeStreamsPerExperiment (bool enableCtsRts, uint16_t NumofNode, SweepPoint const &point, std::string const &outputRoot)
+{
+  int fds[2];
+  NS_ABORT_MSG_IF (pipe (fds) != 0, "ProbeStreamsPerExperiment: pipe () failed");
+  std::cout.flush ();
+  pid_t pid = fork ();
+  NS_ABORT_MSG_IF (pid < 0, "ProbeStreamsPerExperiment: fork () failed");
+  if (pid == 0)
+    {
+      close (fds[0]);
+      uint16_t probeDuration = (uint16_t)(3.100 + NumofNode/2*0.01) + 2;
+      uint64_t first = RngSeedManager::GetNextStreamIndex ();
+      experiment (enableCtsRts, NumofNode, probeDuration, point.firstNodeLoad, point.restNodeLoad, outputRoot + "/.probe");
+      uint64_t streams = RngSeedManager::GetNextStreamIndex () - first - 1;
+      ssize_t written = write (fds[1], &streams, sizeof (streams));
+      close (fds[1]);
+      _exit (written == sizeof (streams) ? 0 : 1);
+    }
+  close (fds[1]);
+  uint64_t streams = 0;
+  ssize_t got = read (fds[0], &streams, sizeof (streams));
+  close (fds[0]);
+  int status;
+  waitpid (pid, &status, 0);
+  NS_ABORT_MSG_UNLESS (got == sizeof (streams) && WIFEXITED (status) && WEXITSTATUS (status) == 0,
+                       "ProbeStreamsPerExperiment: probe process failed");
+  return streams;
+}
+
+
+//key identifying a sweep point in the timing records
+std::string TimingKey (uint16_t NumofNode, double FirstNodeLoad, double RestNodeLoad)
+{
+  char key [64];
+  snprintf (key, sizeof (key), "%u %.4f %.4f", (unsigned int) NumofNode, FirstNodeLoad, RestNodeLoad);
+  return key;
+}
+
+
+/*
+ * Past timing records, one line per simulated point:
+ *   <NumofNode> <FirstNodeLoad> <RestNodeLoad> <DurationofSimulation> <wall seconds>
+ * Returns, per point key, the wall time per simulated second of the latest record.
+ */
+std::map<std::string, double> LoadTimingRecords (std::string const &timingFile)
+{
+  std::map<std::string, double> rates;
+  std::ifstream in (timingFile.c_str ());
+  unsigned int nodes;
+  double first, rest, duration, wall;
+  while (in >> nodes >> first >> rest >> duration >> wall)
+    {
+      if (duration > 0)
+        {
+          rates[TimingKey (nodes, first, rest)] = wall / duration;
+        }
+    }
+  return rates;
+}
+
+void AppendTimingRecord (std::string const &timingFile, uint16_t NumofNode, SweepPoint const &point,
+                         double DurationofSimulation, double wallSeconds)
+{
+  std::ofstream out (timingFile.c_str (), std::ios_base::app);
+  out << TimingKey (NumofNode, point.firstNodeLoad, point.restNodeLoad) << " "
+      << DurationofSimulation << " " << wallSeconds << std::endl;
+}
+
+
+//simulated seconds of a point: the stop time chosen by the run-length controller, if it ran
+double SimulatedSeconds (std::string const &outputRoot, SweepPoint const &point, uint32_t DurationofSimulation)
+{
+  std::ifstream in ((PointDirectory (outputRoot, point.firstNodeLoad, point.restNodeLoad) + "/runlength.txt").c_str ());
+  double stop = 0;
+  if (in >> stop && stop > 0)
+    {
+      return stop;
+    }
+  return DurationofSimulation;
+}
+
+
+//mean of one column (1-based, as in the MATLAB scripts) of an athstats file, skipping the first rows
+double SteadyStateMean (std::string const &filename, uint32_t column, uint32_t skipRows)
+{
+  std::ifstream in (filename.c_str ());
+  NS_ABORT_MSG_UNLESS (in.is_open (), "SteadyStateMean: cannot open " << filename);
+  std::string line;
+  uint32_t row = 0;
+  double sum = 0;
+  uint32_t count = 0;
+  while (std::getline (in, line))
+    {
+      if (row++ < skipRows)
+        {
+          continue;
+        }
+      std::istringstream fields (line);
+      double value = 0;
+      for (uint32_t c = 0; c < column && (fields >> value); ++c)
+        {
+        }
+      sum += value;
+      ++count;
+    }
+  return count > 0 ? sum / count : 0;
+}
+
+
+//rows to discard from an athstats file: the MSER cut-off the trace sink recorded, unless skipRows overrides it
+uint32_t WarmupRows (std::string const &filename, uint32_t skipRows)
+{
+  if (skipRows > 0)
+    {
+      return skipRows;
+    }
+  std::ifstream in ((filename + ".warmup").c_str ());
+  uint32_t rows = 0;
+  if (!(in >> rows))
+    {
+      rows = 149;   // cut-off used before the sink recorded one
+    }
+  return rows;
+}
+
+
+//64-bit FNV-1a hash
+uint64_t HashString (std::string const &text)
+{
+  uint64_t hash = 14695981039346656037ULL;
+  for (size_t i = 0; i < text.size (); ++i)
+    {
+      hash ^= (unsigned char) text[i];
+      hash *= 1099511628211ULL;
+    }
+  return hash;
+}
+
+
+//manifest marking the files of a point of one replication as complete
+std::string CompleteFile (std::string const &outputRoot, SweepPoint const &point)
+{
+  return PointDirectory (ReplicationRoot (outputRoot, point.run), point.firstNodeLoad, point.restNodeLoad) + "/COMPLETE";
+}
+
+
+//whether the manifest exists and records the results of the same inputs
+bool IsComplete (std::string const &completeFile, std::string const &key)
+{
+  std::ifstream in (completeFile.c_str ());
+  std::ostringstream content;
+  content << in.rdbuf ();
+  return in.is_open () && content.str () == key;
+}
+
+
+//write the manifest once the files of the point are closed; the rename makes it appear whole or not at all
+void WriteComplete (std::string const &completeFile, std::string const &key)
+{
+  std::string temporary = completeFile + ".tmp";
+  {
+    std::ofstream out (temporary.c_str ());
+    out << key;
+  }
+  NS_ABORT_MSG_IF (rename (temporary.c_str (), completeFile.c_str ()) != 0,
+                   "WriteComplete: cannot rename " << temporary);
+}
+
+
+/*
+ * Runs batches of sweep points, either in this process or on a pool of
+ * worker processes, for the sweep modes of main ().
+ */
+class SweepRunner
+{
+public:
+  SweepRunner (bool enableCtsRts, uint16_t NumofNode, uint32_t DurationofSimulation, std::string const &outputRoot,
+               uint32_t workers, uint16_t pilotDuration, uint32_t replications = 1,
+               ExperimentOptions const &options = ExperimentOptions (), bool cache = true);
+
+  /**
+   * Simulate the points and wait for all of them to complete.
+   *
+   * With several replications, every point is simulated once per RngRun
+   * 1..replications, each run in the folders under run_XXX, and the runs are
+   * summarized in summary.txt in the folder of the point.
+   *
+   * With the cache, every point runs in a worker, even with a single one, and
+   * points whose COMPLETE manifest records the same inputs are not simulated
+   * again. A point without a manifest, as left by a crash, is simulated anew.
+   *
+   * In this process the points run in the given order. On the pool they are
+   * dispatched longest first, so that the heavy high-load points do not end
+   * up as a tail running on a single core. The cost of a point is predicted
+   * from the timing records of earlier sweeps or, when there is none and the
+   * pilot duration is not zero, from a short pilot run of the point; points
+   * with neither take the prediction of the nearest known point.
+   */
+  void Run (std::vector<SweepPoint> const &points);
+
+  /**
+   * Merge the replications of each point into summary.txt, one line per node:
+   *   <node> <utilization mean> <variance> <95% half-width>
+   *          <throughput mean (bytes/s)> <variance> <95% half-width> <runs>
+   * Utilization is column 9 and throughput column 2 of the athstats files,
+   * averaged after the warm-up detected in each run.
+   */
+  void Summarize (std::vector<SweepPoint> const &points) const;
+
+  /**
+   * Only run the jobs whose index modulo shardCount is shardIndex, and list
+   * them in shard_<index>_of_<count>.txt for the merge mode:
+   *   shard <index> <count> jobs <jobs of the whole sweep> replications <replications> cache <0|1>
+   *   <job index> <run> <FirstNodeLoad> <RestNodeLoad>
+   * The jobs keep the stream offsets of the whole sweep, so the shards
+   * together hold the files of a sweep run on a single host.
+   */
+  void SetShard (uint32_t shardIndex, uint32_t shardCount);
+
+  std::string const &GetOutputRoot (void) const;
+  uint32_t GetWorkers (void) const;
+  uint32_t GetReplications (void) const;
+
+private:
+  /**
+   * Everything the files of a job depend on, and its hash: the chain, the
+   * loads, the duration, the seed, run and stream offset, the options, the
+   * attribute defaults, and the build of this program.
+   */
+  std::string JobKey (SweepPoint const &job, uint32_t DurationofSimulation) const;
+
+  /**
+   * One job per point and replication, numbered in the serial order of the jobs.
+   */
+  std::vector<SweepPoint> ExpandReplications (std::vector<SweepPoint> const &points) const;
+
+  /**
+   * Simulate the points on the workers, dispatching them in the given order.
+   * Each worker skips the stream indices of the points that precede it in the
+   * serial sweep, so the dispatch order does not change the results.
+   *
+   * With snapshots, this process instead simulates the chain once up to the
+   * start of the CBR flows, and each worker is forked from that state and only
+   * sets the loads of its point. The workers then share the random streams
+   * of the warm-up, so their results differ from those of the serial sweep,
+   * but they still do not depend on the dispatch order.
+   *
+   * Returns the wall time spent on each point.
+   */
+  std::vector<double> RunOnWorkers (std::vector<SweepPoint> const &points, std::vector<size_t> const &order,
+                                    uint32_t DurationofSimulation, std::string const &outputRoot, bool verbose);
+
+  /**
+   * Gather the status files of the running workers into status.txt, with
+   * the progress of the whole sweep, and print it to stderr if requested.
+   * The ETA of the sweep shares the remaining time of the running points
+   * and the mean wall time of a point for the queued ones among the workers.
+   */
+  void ReportProgress (std::vector<SweepPoint> const &points, std::map<pid_t, size_t> const &running,
+                       std::string const &outputRoot, size_t queued, size_t done, double doneWallSeconds,
+                       double sweepStart) const;
+
+  /**
+   * Simulate the points in this process on a single chain, built once and
+   * run past the ARP warm-up. Between two points ResetChain clears its
+   * dynamic state and installs new senders, which start with the ARP warm-up
+   * at the offsets of a new chain, and every random variable takes the
+   * streams of the point. Only the MAC sequence numbers and the UDP source
+   * ports go on from the points run before. The files differ from those of
+   * the default runs, which draw other random streams.
+   */
+  void RunReused (std::vector<SweepPoint> const &points) const;
+
+  bool m_enableCtsRts;
+  uint16_t m_numofNode;
+  uint32_t m_duration;
+  std::string m_outputRoot;
+  uint32_t m_workers;
+  uint16_t m_pilotDuration;
+  uint32_t m_replications;
+  ExperimentOptions m_options;
+  bool m_cache;
+  uint32_t m_shardIndex;
+  uint32_t m_shardCount;
+  std::string m_timingFile;
+  bool m_probed;
+  uint64_t m_streamsPerExperiment;
+};
+
+SweepRunner::SweepRunner (bool enableCtsRts, uint16_t NumofNode, uint32_t DurationofSimulation, std::string const &outputRoot,
+                          uint32_t workers, uint16_t pilotDuration, uint32_t replications,
+                          ExperimentOptions const &options, bool cache)
+  : m_enableCtsRts (enableCtsRts),
+    m_numofNode (NumofNode),
+    m_duration (DurationofSimulation),
+    m_outputRoot (outputRoot),
+    m_workers (workers),
+    m_pilotDuration (pilotDuration),
+    m_replications (replications),
+    m_options (options),
+    m_cache (cache && !options.snapshot && !options.reuse),
+    m_shardIndex (0),
+    m_shardCount (1),
+    m_timingFile (outputRoot + "/timing.txt"),
+    m_probed (false),
+    m_streamsPerExperiment (0)
+{
+  NS_ABORT_MSG_IF (m_replications > 1 && m_options.snapshot,
+                   "SweepRunner: replications cannot be forked from one snapshot, whose random streams they would share");
+  NS_ABORT_MSG_IF (m_options.reuse && (m_options.snapshot || m_workers > 1),
+                   "SweepRunner: a reused chain runs its points one after the other in this process");
+  NS_ABORT_MSG_IF (m_options.reuse && (!m_options.levels.empty () || m_options.rampDwell > 0),
+                   "SweepRunner: splitting and ramp runs cannot reuse a chain");
+}
+
+void
+SweepRunner::SetShard (uint32_t shardIndex, uint32_t shardCount)
+{
+  NS_ABORT_MSG_UNLESS (shardCount >= 1 && shardIndex < shardCount,
+                       "SweepRunner: shard " << shardIndex << " of " << shardCount << " does not exist");
+  m_shardIndex = shardIndex;
+  m_shardCount = shardCount;
+}
+
+std::string const &
+SweepRunner::GetOutputRoot (void) const
+{
+  return m_outputRoot;
+}
+
+uint32_t
+SweepRunner::GetWorkers (void) const
+{
+  return m_workers;
+}
+
+uint32_t
+SweepRunner::GetReplications (void) const
+{
+  return m_replications;
+}
+
+std::string
+SweepRunner::JobKey (SweepPoint const &job, uint32_t DurationofSimulation) const
+{
+  std::ostringstream key;
+  key << std::setprecision (17)
+      << "nodes " << m_numofNode << "\n"
+      << "duration " << DurationofSimulation << "\n"
+      << "first " << job.firstNodeLoad << "\n"
+      << "rest " << job.restNodeLoad << "\n"
+      << "rtscts " << m_enableCtsRts << "\n"
+      << "seed " << RngSeedManager::GetSeed () << "\n"
+      << "run " << (job.run > 0 ? job.run : RngSeedManager::GetRun ()) << "\n"
+      << "streams " << job.index * m_streamsPerExperiment << "\n"
+      << "ci " << m_options.ciPrecision << " " << m_options.ciBatches;
+  for (size_t i = 0; i < m_options.ciNodes.size (); ++i)
+    {
+      key << " " << m_options.ciNodes[i];
+    }
+  key << "\n"
+      << "crn " << m_options.crn << "\n"
+      << "splitting " << m_options.splitFactor << " " << m_options.frontUtilization << " " << m_options.frontWindow;
+  for (size_t i = 0; i < m_options.levels.size (); ++i)
+    {
+      key << " " << m_options.levels[i];
+    }
+  key << "\n"
+      << "ramp " << m_options.rampStep << " " << m_options.rampDwell << " " << m_options.rampSettle << "\n"
+      << "neighbours " << m_options.neighbours << "\n"
+      << "culling " << m_options.culling << "\n"
+      << "perTable " << m_options.perTable << "\n";
+  std::vector<std::pair<std::string, std::string> > defaults = ExperimentDefaults (m_enableCtsRts);
+  for (size_t i = 0; i < defaults.size (); ++i)
+    {
+      key << defaults[i].first << " " << defaults[i].second << "\n";
+    }
+  key << "model " << modelVersion << "\n";
+
+  char hash [32];
+  snprintf (hash, sizeof (hash), "%016llx\n", (unsigned long long) HashString (key.str ()));
+  return hash + key.str ();
+}
+
+std::vector<SweepPoint>
+SweepRunner::ExpandReplications (std::vector<SweepPoint> const &points) const
+{
+  if (m_replications <= 1)
+    {
+      return points;
+    }
+  std::vector<SweepPoint> jobs;
+  for (size_t i = 0; i < points.size (); ++i)
+    {
+      for (uint32_t run = 1; run <= m_replications; ++run)
+        {
+          SweepPoint job = points[i];
+          job.index = points[i].index * m_replications + run - 1;
+          job.run = run;
+          jobs.push_back (job);
+        }
+    }
+  return jobs;
+}
+
+void
+SweepRunner::Summarize (std::vector<SweepPoint> const &points) const
+{
+  if (m_shardCount > 1)
+    {
+      // the runs of a point may be spread over several shards: summarized by the merge
+      return;
+    }
+  if (m_replications <= 1)
+    {
+      // a summary left by an earlier replicated sweep would hide the new single run
+      for (size_t i = 0; i < points.size (); ++i)
+        {
+          unlink ((PointDirectory (m_outputRoot, points[i].firstNodeLoad, points[i].restNodeLoad) + "/summary.txt").c_str ());
+        }
+      return;
+    }
+  for (size_t i = 0; i < points.size (); ++i)
+    {
+      std::string foldername = MakePointDirectory (m_outputRoot, points[i].firstNodeLoad, points[i].restNodeLoad);
+      std::ofstream out ((foldername + "/summary.txt").c_str ());
+      for (uint16_t node = 0; node < m_numofNode; ++node)
+        {
+          std::vector<double> utilization;
+          std::vector<double> throughput;
+          for (uint32_t run = 1; run <= m_replications; ++run)
+            {
+              std::ostringstream filename;
+              filename << PointDirectory (ReplicationRoot (m_outputRoot, run), points[i].firstNodeLoad, points[i].restNodeLoad)
+                       << "/nodes_" << std::setfill ('0') << std::setw (3) << node << "_000";
+              uint32_t skipRows = WarmupRows (filename.str (), 0);
+              utilization.push_back (SteadyStateMean (filename.str (), 9, skipRows));
+              throughput.push_back (SteadyStateMean (filename.str (), 2, skipRows));
+            }
+          out << node;
+          std::vector<double> const *series[] = { &utilization, &throughput };
+          for (size_t k = 0; k < 2; ++k)
+            {
+              std::vector<double> const &values = *series[k];
+              double mean = 0;
+              for (size_t v = 0; v < values.size (); ++v)
+                {
+                  mean += values[v];
+                }
+              mean /= values.size ();
+              double variance = 0;
+              for (size_t v = 0; v < values.size (); ++v)
+                {
+                  variance += (values[v] - mean) * (values[v] - mean);
+                }
+              variance /= values.size () - 1;
+              out << " " << mean << " " << variance << " "
+                  << StudentT95 (values.size () - 1) * std::sqrt (variance / values.size ());
+            }
+          out << " " << m_replications << std::endl;
+        }
+    }
+}
+
+void
+SweepRunner::ReportProgress (std::vector<SweepPoint> const &points, std::map<pid_t, size_t> const &running,
+                             std::string const &outputRoot, size_t queued, size_t done, double doneWallSeconds,
+                             double sweepStart) const
+{
+  std::ostringstream table;
+  double remaining = 0;
+  double projected = 0;
+  uint32_t reported = 0;
+  uint64_t rss = 0;
+  for (std::map<pid_t, size_t>::const_iterator it = running.begin (); it != running.end (); ++it)
+    {
+      SweepPoint const &point = points[it->second];
+      std::ostringstream filename;
+      filename << outputRoot << "/.status/" << it->first;
+      std::ifstream in (filename.str ().c_str ());
+      double simulated, duration, eventRate, wall, eta;
+      uint64_t events, kilobytes;
+      char line [160];
+      if (in >> simulated >> duration >> events >> eventRate >> kilobytes >> wall >> eta)
+        {
+          snprintf (line, sizeof (line), " %10.4f %10.4f %4u %9.1f/%-6.0f %10.0f %9.1f %9.0f %9.0f",
+                    point.firstNodeLoad, point.restNodeLoad, point.run, simulated, duration, eventRate,
+                    kilobytes / 1024.0, wall, eta);
+          remaining += eta;
+          projected += wall + eta;
+          rss += kilobytes;
+          ++reported;
+        }
+      else
+        {
+          snprintf (line, sizeof (line), " %10.4f %10.4f %4u  starting", point.firstNodeLoad, point.restNodeLoad, point.run);
+        }
+      table << line << std::endl;
+    }
+  double meanPoint = done > 0 ? doneWallSeconds / done : (reported > 0 ? projected / reported : 0);
+  uint32_t workers = std::max<uint32_t> (m_workers, 1);
+  double sweepEta = (remaining + queued * meanPoint) / workers;
+
+  std::ostringstream report;
+  report << " points: " << done << " done, " << running.size () << " running, " << queued << " queued; elapsed "
+         << (long) (WallClockSeconds () - sweepStart) << " s; sweep ETA " << (long) sweepEta << " s; RSS "
+         << rss / 1024 << " MB" << std::endl
+         << " first node  rest node  run  simulated (s)    events/s  RSS (MB)  wall (s)   ETA (s)" << std::endl
+         << table.str ();
+  std::string temporary = outputRoot + "/status.txt.tmp";
+  {
+    std::ofstream out (temporary.c_str ());
+    out << report.str ();
+  }
+  rename (temporary.c_str (), (outputRoot + "/status.txt").c_str ());
+  if (m_options.progressStderr)
+    {
+      std::cerr << report.str ();
+    }
+}
+
+void
+SweepRunner::RunReused (std::vector<SweepPoint> const &points) const
+{
+  if (points.empty ())
+    {
+      return;
+    }
+  ExperimentOptions options = m_options;
+  if (options.progressInterval > 0)
+    {
+      mkdir (m_outputRoot.c_str (), S_IRWXU | S_IRWXG | S_IRWXO);
+      options.statusFile = m_outputRoot + "/status.txt";
+    }
+
+  // build the chain and run it until every flow has started
+  double setupStart = WallClockSeconds ();
+  Chain chain;
+  BuildChain (m_enableCtsRts, m_numofNode, points[0].firstNodeLoad, points[0].restNodeLoad, chain, m_options);
+  mkdir (m_outputRoot.c_str (), S_IRWXU | S_IRWXG | S_IRWXO);
+  mkdir ((m_outputRoot + "/.reuse").c_str (), S_IRWXU | S_IRWXG | S_IRWXO);
+  chain.athstats.EnableAthstats (m_outputRoot + "/.reuse/nodes", chain.devices);
+  int64_t streams = ReseedChain (chain, reuseStream, m_options.crn);
+  Simulator::Stop (Seconds ((uint16_t)(3.100 + m_numofNode/2*0.01) + 2));
+  Simulator::Run ();
+  std::cout << " chain built in " << WallClockSeconds () - setupStart << " s" << std::endl;
+
+  for (size_t i = 0; i < points.size (); ++i)
+    {
+      SweepPoint const &point = points[i];
+      std::cout << " first node = " << point.firstNodeLoad << " rest node = " << point.restNodeLoad << std::endl;
+      uint64_t before = ResidentKilobytes ();
+      ResetPeakResident ();
+      double resetStart = WallClockSeconds ();
+      if (point.run > 0)
+        {
+          RngSeedManager::SetRun (point.run);
+        }
+      std::string foldername = MakePointDirectory (ReplicationRoot (m_outputRoot, point.run),
+                                                   point.firstNodeLoad, point.restNodeLoad);
+      unlink (CompleteFile (m_outputRoot, point).c_str ());
+      ResetChain (chain, point.firstNodeLoad, point.restNodeLoad, foldername, m_options.crn);
+      ReseedChain (chain, reuseStream + (int64_t) point.index * streams, m_options.crn);
+      std::cout << " chain reset in " << WallClockSeconds () - resetStart << " s" << std::endl;
+      RunChain (chain, m_duration, foldername, options);
+      chain.athstats.Flush ();
+      WriteMemoryReport (foldername + "/memory.txt", before, PeakResidentKilobytes (), ResidentKilobytes ());
+    }
+  TeardownChain (chain);
+}
+
+std::vector<double>
+SweepRunner::RunOnWorkers (std::vector<SweepPoint> const &points, std::vector<size_t> const &order,
+                           uint32_t DurationofSimulation, std::string const &outputRoot, bool verbose)
+{
+  std::vector<double> wallSeconds (points.size (), 0);
+  std::vector<double> started (points.size (), 0);
+  std::map<pid_t, size_t> running;
+  size_t next = 0;
+  uint32_t failed = 0;
+
+  // the echo packets resolving ARP are exchanged by then, and the first CBR flow starts at 3.1 s
+  const double sharedPrefixEnd = 3.0;
+  bool snapshot = m_options.snapshot && !order.empty () && DurationofSimulation > sharedPrefixEnd;
+  Chain chain;
+  if (snapshot)
+    {
+      SweepPoint const &first = points[order[0]];
+      BuildChain (m_enableCtsRts, m_numofNode, first.firstNodeLoad, first.restNodeLoad, chain, m_options);
+      mkdir (outputRoot.c_str (), S_IRWXU | S_IRWXG | S_IRWXO);
+      mkdir ((outputRoot + "/.prefix").c_str (), S_IRWXU | S_IRWXG | S_IRWXO);
+      chain.athstats.EnableAthstats (outputRoot + "/.prefix/nodes", chain.devices);
+      Simulator::Stop (Seconds (sharedPrefixEnd));
+      Simulator::Run ();
+      chain.athstats.Flush ();
+    }
+
+  bool progress = verbose && m_options.progressInterval > 0;
+  ExperimentOptions options = m_options;
+  options.progressStderr = false;
+  if (progress)
+    {
+      mkdir (outputRoot.c_str (), S_IRWXU | S_IRWXG | S_IRWXO);
+      mkdir ((outputRoot + "/.status").c_str (), S_IRWXU | S_IRWXG | S_IRWXO);
+    }
+  else
+    {
+      options.progressInterval = 0;
+    }
+  double sweepStart = WallClockSeconds ();
+  double lastReport = sweepStart;
+  size_t done = 0;
+  double doneWallSeconds = 0;
+
+  uint32_t workers = std::max<uint32_t> (m_workers, 1);
+  while (next < order.size () || !running.empty ())
+    {
+      while (next < order.size () && running.size () < workers)
+        {
+          size_t p = order[next++];
+          SweepPoint const &point = points[p];
+          if (verbose)
+            {
+              std::cout << " first node = " << point.firstNodeLoad << " rest node = " << point.restNodeLoad << std::endl;
+            }
+          std::cout.flush ();
+          pid_t pid = fork ();
+          NS_ABORT_MSG_IF (pid < 0, "SweepRunner: fork () failed");
+          if (pid == 0)
+            {
+              std::ostringstream statusFile;
+              statusFile << outputRoot << "/.status/" << getpid ();
+              options.statusFile = statusFile.str ();
+            }
+          if (pid == 0 && snapshot)
+            {
+              SetChainLoads (chain, point.firstNodeLoad, point.restNodeLoad);
+              for (uint32_t i = 0; m_options.crn && i + 1 < chain.senders.GetN (); ++i)
+                {
+                  DynamicCast<OnOffApplication> (chain.senders.Get (i))->AssignStreams (chain.crnSenderStream + 2*i);
+                }
+              std::string foldername = MakePointDirectory (outputRoot, point.firstNodeLoad, point.restNodeLoad);
+              unlink (CompleteFile (outputRoot, point).c_str ());
+              chain.athstats.Redirect (foldername + "/nodes");
+              RunChain (chain, DurationofSimulation, foldername, options);
+              TeardownChain (chain);
+              std::cout.flush ();
+              _exit (0);
+            }
+          if (pid == 0)
+            {
+              for (uint64_t k = 0; k < point.index * m_streamsPerExperiment; ++k)
+                {
+                  RngSeedManager::GetNextStreamIndex ();
+                }
+              if (point.run > 0)
+                {
+                  RngSeedManager::SetRun (point.run);
+                }
+              std::string completeFile = CompleteFile (outputRoot, point);
+              unlink (completeFile.c_str ());
+              experiment (m_enableCtsRts, m_numofNode, DurationofSimulation, point.firstNodeLoad, point.restNodeLoad,
+                          ReplicationRoot (outputRoot, point.run), options);
+              if (m_cache)
+                {
+                  WriteComplete (completeFile, JobKey (point, DurationofSimulation));
+                }
+              std::cout.flush ();
+              _exit (0);
+            }
+          started[p] = WallClockSeconds ();
+          running[pid] = p;
+        }
+
+      int status;
+      pid_t pid = waitpid (-1, &status, progress ? WNOHANG : 0);
+      while (pid == 0)
+        {
+          if (WallClockSeconds () - lastReport >= m_options.progressInterval)
+            {
+              ReportProgress (points, running, outputRoot, order.size () - next, done, doneWallSeconds, sweepStart);
+              lastReport = WallClockSeconds ();
+            }
+          usleep (200000);
+          pid = waitpid (-1, &status, WNOHANG);
+        }
+      if (pid < 0)
+        {
+          break;
+        }
+      std::map<pid_t, size_t>::iterator it = running.find (pid);
+      if (it == running.end ())
+        {
+          continue;
+        }
+      size_t p = it->second;
+      wallSeconds[p] = WallClockSeconds () - started[p];
+      ++done;
+      doneWallSeconds += wallSeconds[p];
+      if (progress)
+        {
+          std::ostringstream statusFile;
+          statusFile << outputRoot << "/.status/" << pid;
+          unlink (statusFile.str ().c_str ());
+        }
+      if (!WIFEXITED (status) || WEXITSTATUS (status) != 0)
+        {
+          std::cerr << " worker for first node = " << points[p].firstNodeLoad
+                    << " rest node = " << points[p].restNodeLoad << " failed" << std::endl;
+          ++failed;
+        }
+      running.erase (it);
+    }
+  if (progress)
+    {
+      ReportProgress (points, running, outputRoot, 0, done, doneWallSeconds, sweepStart);
+    }
+  if (snapshot)
+    {
+      TeardownChain (chain);
+    }
+  NS_ABORT_MSG_IF (failed > 0, "SweepRunner: " << failed << " sweep points failed");
+  return wallSeconds;
+}
+
+void
+SweepRunner::Run (std::vector<SweepPoint> const &sweepPoints)
+{
+  std::vector<SweepPoint> points = ExpandReplications (sweepPoints);
+  if (m_shardCount > 1)
+    {
+      mkdir (m_outputRoot.c_str (), S_IRWXU | S_IRWXG | S_IRWXO);
+      char filename [64];
+      snprintf (filename, sizeof (filename), "/shard_%03u_of_%03u.txt", m_shardIndex, m_shardCount);
+      std::ofstream manifest ((m_outputRoot + filename).c_str ());
+      manifest << "shard " << m_shardIndex << " " << m_shardCount << " jobs " << points.size ()
+               << " replications " << m_replications << " cache " << m_cache << std::endl;
+      std::vector<SweepPoint> shard;
+      for (size_t i = 0; i < points.size (); ++i)
+        {
+          if (points[i].index % m_shardCount == m_shardIndex)
+            {
+              manifest << points[i].index << " " << points[i].run << " " << std::setprecision (17)
+                       << points[i].firstNodeLoad << " " << points[i].restNodeLoad << std::endl;
+              shard.push_back (points[i]);
+            }
+        }
+      points = shard;
+    }
+  if (m_options.reuse)
+    {
+      RunReused (points);
+      Summarize (sweepPoints);
+      return;
+    }
+  if (m_workers <= 1 && !m_options.snapshot && !m_cache && m_shardCount <= 1)
+    {
+      for (size_t i = 0; i < points.size (); ++i)
+        {
+          std::cout << " first node = " << points[i].firstNodeLoad << " rest node = " << points[i].restNodeLoad << std::endl;
+          if (points[i].run > 0)
+            {
+              RngSeedManager::SetRun (points[i].run);
+            }
+          ExperimentOptions options = m_options;
+          if (options.progressInterval > 0)
+            {
+              mkdir (m_outputRoot.c_str (), S_IRWXU | S_IRWXG | S_IRWXO);
+              options.statusFile = m_outputRoot + "/status.txt";
+            }
+          experiment (m_enableCtsRts, m_numofNode, m_duration, points[i].firstNodeLoad, points[i].restNodeLoad,
+                      ReplicationRoot (m_outputRoot, points[i].run), options);
+        }
+      Summarize (sweepPoints);
+      return;
+    }
+
+  mkdir (m_outputRoot.c_str (), S_IRWXU | S_IRWXG | S_IRWXO);
+  if (!m_probed && !m_options.snapshot && !points.empty ())
+    {
+      m_streamsPerExperiment = ProbeStreamsPerExperiment (m_enableCtsRts, m_numofNode, points[0], m_outputRoot);
+      m_probed = true;
+    }
+
+  // 0. leave out the points whose results are complete
+  if (m_cache)
+    {
+      std::vector<SweepPoint> pending;
+      for (size_t i = 0; i < points.size (); ++i)
+        {
+          if (IsComplete (CompleteFile (m_outputRoot, points[i]), JobKey (points[i], m_duration)))
+            {
+              std::cout << " first node = " << points[i].firstNodeLoad << " rest node = " << points[i].restNodeLoad
+                        << " complete" << std::endl;
+            }
+          else
+            {
+              pending.push_back (points[i]);
+            }
+        }
+      points = pending;
+    }
+
+  // 1. predict the wall time of every point
+  std::map<std::string, double> rates = LoadTimingRecords (m_timingFile);
+  std::vector<double> predicted (points.size (), -1);
+  std::vector<std::string> source (points.size (), "-");
+  std::vector<size_t> unknown;
+  for (size_t i = 0; i < points.size (); ++i)
+    {
+      std::map<std::string, double>::const_iterator rate =
+        rates.find (TimingKey (m_numofNode, points[i].firstNodeLoad, points[i].restNodeLoad));
+      if (rate != rates.end ())
+        {
+          predicted[i] = rate->second * m_duration;
+          source[i] = "record";
+        }
+      else
+        {
+          unknown.push_back (i);
+        }
+    }
+  if (m_pilotDuration > 0 && !unknown.empty ())
+    {
+      // one pilot per point; the other replications of the point take its prediction below
+      std::vector<size_t> pilots;
+      std::vector<size_t> others;
+      for (size_t k = 0; k < unknown.size (); ++k)
+        {
+          (points[unknown[k]].run <= 1 ? pilots : others).push_back (unknown[k]);
+        }
+      std::cout << " running " << pilots.size () << " pilots of " << m_pilotDuration << " s" << std::endl;
+      std::vector<double> pilotWall = RunOnWorkers (points, pilots, m_pilotDuration, m_outputRoot + "/.pilot", false);
+      for (size_t k = 0; k < pilots.size (); ++k)
+        {
+          size_t i = pilots[k];
+          double simulated = SimulatedSeconds (ReplicationRoot (m_outputRoot + "/.pilot", points[i].run), points[i], m_pilotDuration);
+          predicted[i] = pilotWall[i] * m_duration / simulated;
+          source[i] = "pilot";
+          AppendTimingRecord (m_timingFile, m_numofNode, points[i], simulated, pilotWall[i]);
+        }
+      unknown = others;
+    }
+  for (size_t k = 0; k < unknown.size (); ++k)
+    {
+      size_t i = unknown[k];
+      double nearest = std::numeric_limits<double>::max ();
+      for (size_t j = 0; j < points.size (); ++j)
+        {
+          double distance = std::fabs (points[j].firstNodeLoad - points[i].firstNodeLoad)
+            + std::fabs (points[j].restNodeLoad - points[i].restNodeLoad);
+          if ((source[j] == "record" || source[j] == "pilot") && distance < nearest)
+            {
+              nearest = distance;
+              predicted[i] = predicted[j];
+              source[i] = "nearest";
+            }
+        }
+    }
+
+  // 2. longest job first; without any prediction the attacker load is the best proxy of the cost
+  std::vector<std::pair<std::pair<double, double>, size_t> > ranked;
+  for (size_t i = 0; i < points.size (); ++i)
+    {
+      ranked.push_back (std::make_pair (std::make_pair (-predicted[i], -points[i].firstNodeLoad), i));
+    }
+  std::sort (ranked.begin (), ranked.end ());
+  std::vector<size_t> order;
+  for (size_t k = 0; k < ranked.size (); ++k)
+    {
+      order.push_back (ranked[k].second);
+    }
+
+  // 3. run and report predicted versus actual wall time
+  std::vector<double> actual = RunOnWorkers (points, order, m_duration, m_outputRoot, true);
+  std::cout << std::endl << " first node  rest node  predicted (s)  actual (s)  source" << std::endl;
+  for (size_t k = 0; k < order.size (); ++k)
+    {
+      size_t i = order[k];
+      AppendTimingRecord (m_timingFile, m_numofNode, points[i],
+                          SimulatedSeconds (ReplicationRoot (m_outputRoot, points[i].run), points[i], m_duration), actual[i]);
+      char line [128];
+      if (predicted[i] < 0)
+        {
+          snprintf (line, sizeof (line), " %10.4f %10.4f %14s %11.1f  %s", points[i].firstNodeLoad, points[i].restNodeLoad,
+                    "-", actual[i], source[i].c_str ());
+        }
+      else
+        {
+          snprintf (line, sizeof (line), " %10.4f %10.4f %14.1f %11.1f  %s", points[i].firstNodeLoad, points[i].restNodeLoad,
+                    predicted[i], actual[i], source[i].c_str ());
+        }
+      std::cout << line << std::endl;
+    }
+  Summarize (sweepPoints);
+}
+
+
+//utilization (column 9) of each victim node at one sweep point, averaged over the replications if there are several
+std::vector<double> VictimUtilization (std::string const &outputRoot, SweepPoint const &point,
+                                       std::vector<uint32_t> const &victims, uint32_t skipRows)
+{
+  std::vector<double> utilization;
+  std::ifstream summary ((PointDirectory (outputRoot, point.firstNodeLoad, point.restNodeLoad) + "/summary.txt").c_str ());
+  if (summary.is_open ())
+    {
+      std::map<uint32_t, double> means;
+      std::string line;
+      while (std::getline (summary, line))
+        {
+          std::istringstream fields (line);
+          uint32_t node;
+          double mean;
+          if (fields >> node >> mean)
+            {
+              means[node] = mean;
+            }
+        }
+      for (size_t v = 0; v < victims.size (); ++v)
+        {
+          utilization.push_back (means[victims[v]]);
+        }
+      return utilization;
+    }
+  for (size_t v = 0; v < victims.size (); ++v)
+    {
+      std::ostringstream filename;
+      filename << PointDirectory (outputRoot, point.firstNodeLoad, point.restNodeLoad)
+               << "/nodes_" << std::setfill ('0') << std::setw (3) << victims[v] << "_000";
+      utilization.push_back (SteadyStateMean (filename.str (), 9, WarmupRows (filename.str (), skipRows)));
+    }
+  return utilization;
+}
+
+
+//split a comma-separated list
+std::vector<std::string> SplitList (std::string const &list)
+{
+  std::vector<std::string> items;
+  std::istringstream in (list);
+  std::string item;
+  while (std::getline (in, item, ','))
+    {
+      if (!item.empty ())
+        {
+          items.push_back (item);
+        }
+    }
+  return items;
+}
+
+
+//parse a comma-separated list of node ids
+std::vector<uint32_t> ParseNodeList (std::string const &list)
+{
+  std::vector<uint32_t> nodes;
+  std::vector<std::string> items = SplitList (list);
+  for (size_t i = 0; i < items.size (); ++i)
+    {
+      nodes.push_back (std::atoi (items[i].c_str ()));
+    }
+  return nodes;
+}
+
+
+//victim utilization of every simulated attacker load, for one RestNodeLoad
+typedef std::map<double, std::vector<double> > LoadResults;
+
+
+/*
+ * Simulate the attacker loads of the list that have no result yet, read the
+ * victim utilization of each and append it to the log as
+ *   <FirstNodeLoad> <RestNodeLoad> <utilization of each victim>
+ */
+void EvaluateLoads (SweepRunner &runner, double restNodeLoad, std::vector<double> const &loads,
+                    std::vector<uint32_t> const &victims, uint32_t skipRows, uint32_t &nextIndex,
+                    LoadResults &evaluated, std::ostream &log)
+{
+  std::vector<SweepPoint> points;
+  for (size_t k = 0; k < loads.size (); ++k)
+    {
+      if (evaluated.find (loads[k]) == evaluated.end ())
+        {
+          SweepPoint point;
+          point.index = nextIndex++;
+          point.run = 0;
+          point.firstNodeLoad = loads[k];
+          point.restNodeLoad = restNodeLoad;
+          points.push_back (point);
+        }
+    }
+  runner.Run (points);
+  for (size_t k = 0; k < points.size (); ++k)
+    {
+      std::vector<double> utilization = VictimUtilization (runner.GetOutputRoot (), points[k], victims, skipRows);
+      evaluated[points[k].firstNodeLoad] = utilization;
+      log << points[k].firstNodeLoad << " " << restNodeLoad;
+      for (size_t v = 0; v < utilization.size (); ++v)
+        {
+          log << " " << utilization[v];
+        }
+      log << std::endl;
+    }
+}
+
+
+/*
+ * Narrow [low, high] to the pair of neighbouring simulated loads across which
+ * the utilization of a victim changes the most; returns that change.
+ */
+double SteepestInterval (LoadResults const &evaluated, double &low, double &high)
+{
+  double jump = -1;
+  double from = low;
+  double to = high;
+  LoadResults::const_iterator previous = evaluated.end ();
+  for (LoadResults::const_iterator it = evaluated.lower_bound (from - 1e-12);
+       it != evaluated.end () && it->first <= to + 1e-12; ++it)
+    {
+      if (previous != evaluated.end ())
+        {
+          for (size_t v = 0; v < it->second.size (); ++v)
+            {
+              double change = std::fabs (it->second[v] - previous->second[v]);
+              if (change > jump)
+                {
+                  jump = change;
+                  low = previous->first;
+                  high = it->first;
+                }
+            }
+        }
+      previous = it;
+    }
+  return jump;
+}
+
+
+/*
+ * Refine the cascade threshold inside [low, high]: each round splits the
+ * steepest interval with as many interior points as there are workers, until
+ * the interval is narrower than the resolution.
+ */
+void RefineThreshold (SweepRunner &runner, double restNodeLoad, double &low, double &high, double resolution,
+                      std::vector<uint32_t> const &victims, uint32_t skipRows, uint32_t &nextIndex,
+                      LoadResults &evaluated, std::ostream &log)
+{
+  SteepestInterval (evaluated, low, high);
+  while (high - low > resolution)
+    {
+      uint32_t splits = std::max<uint32_t> (runner.GetWorkers (), 1);
+      std::vector<double> loads;
+      for (uint32_t k = 1; k <= splits; ++k)
+        {
+          loads.push_back (low + (high - low) * k / (splits + 1));
+        }
+      EvaluateLoads (runner, restNodeLoad, loads, victims, skipRows, nextIndex, evaluated, log);
+      SteepestInterval (evaluated, low, high);
+    }
+}
+
+
+/*
+ * Locate the cascade threshold in FirstNodeLoad for a given RestNodeLoad: a
+ * coarse pass over [minLoad, maxLoad] followed by refinement of the interval
+ * where the utilization of a victim node changes the most. Returns the
+ * bracketing interval.
+ */
+std::pair<double, double> BisectThreshold (SweepRunner &runner, double restNodeLoad, double minLoad, double maxLoad,
+                                           double coarseStep, double resolution, std::vector<uint32_t> const &victims,
+                                           uint32_t skipRows, uint32_t &nextIndex, LoadResults &evaluated, std::ostream &log)
+{
+  std::vector<double> loads;
+  for (uint32_t k = 0; minLoad + k * coarseStep < maxLoad + 1e-9; ++k)
+    {
+      loads.push_back (minLoad + k * coarseStep);
+    }
+  if (loads.back () < maxLoad - 1e-9)
+    {
+      loads.push_back (maxLoad);
+    }
+  EvaluateLoads (runner, restNodeLoad, loads, victims, skipRows, nextIndex, evaluated, log);
+  double low = minLoad;
+  double high = maxLoad;
+  RefineThreshold (runner, restNodeLoad, low, high, resolution, victims, skipRows, nextIndex, evaluated, log);
+  return std::make_pair (low, high);
+}
+
+
+/*
+ * Trace the phase-transition boundary in the (FirstNodeLoad, RestNodeLoad)
+ * plane, one RestNodeLoad after the other.
+ *
+ * The first row is searched with a full coarse pass. Every following row
+ * only simulates a bracket of the given width around the threshold
+ * extrapolated from the previous rows, clamped into [minLoad, maxLoad]; a
+ * bracket that does not contain a jump of at least minJump is moved towards
+ * the side where the victims are still in the state they are in just below
+ * (or above) the last threshold, and is widened, until it does or it leaves
+ * [minLoad, maxLoad], in which case the row falls back to a full coarse pass.
+ * The bracket is then refined as in the bisection mode.
+ *
+ * Writes the boundary polyline to <outputRoot>/boundary.txt as
+ *   <RestNodeLoad> <threshold low> <threshold high>
+ * and the simulated points to <outputRoot>/contour.txt.
+ */
+void TraceBoundary (SweepRunner &runner, double restMin, double restMax, double restStep, double minLoad, double maxLoad,
+                    double coarseStep, double bracketWidth, double minJump, double resolution,
+                    std::vector<uint32_t> const &victims, uint32_t skipRows, uint32_t &nextIndex)
+{
+  std::ofstream log ((runner.GetOutputRoot () + "/contour.txt").c_str (), std::ios_base::app);
+  std::ofstream boundary ((runner.GetOutputRoot () + "/boundary.txt").c_str (), std::ios_base::app);
+  std::vector<std::pair<double, double> > traced;   // (RestNodeLoad, threshold)
+  std::vector<double> below;                         // victim utilization just below the last threshold
+  std::vector<double> above;                         // victim utilization just above the last threshold
+
+  for (uint32_t row = 0; restMin + row * restStep < restMax + 1e-9; ++row)
+    {
+      double rest = restMin + row * restStep;
+      LoadResults evaluated;
+      double low;
+      double high;
+      bool found = true;
+      if (traced.empty ())
+        {
+          std::pair<double, double> interval = BisectThreshold (runner, rest, minLoad, maxLoad, coarseStep, resolution,
+                                                                victims, skipRows, nextIndex, evaluated, log);
+          low = interval.first;
+          high = interval.second;
+        }
+      else
+        {
+          double predicted = traced.back ().second;
+          if (traced.size () > 1)
+            {
+              std::pair<double, double> const &a = traced[traced.size () - 2];
+              std::pair<double, double> const &b = traced.back ();
+              predicted = b.second + (b.second - a.second) * (rest - b.first) / (b.first - a.first);
+            }
+          predicted = std::min (maxLoad, std::max (minLoad, predicted));
+          double width = bracketWidth;
+          low = std::max (minLoad, predicted - width / 2);
+          high = std::min (maxLoad, predicted + width / 2);
+          while (true)
+            {
+              std::vector<double> loads;
+              loads.push_back (low);
+              loads.push_back (high);
+              EvaluateLoads (runner, rest, loads, victims, skipRows, nextIndex, evaluated, log);
+              double from = low;
+              double to = high;
+              if (SteepestInterval (evaluated, from, to) >= minJump)
+                {
+                  break;
+                }
+              // both ends are on the same side of the transition: which one?
+              std::vector<double> const &u = evaluated[low];
+              double toBelow = 0;
+              double toAbove = 0;
+              for (size_t v = 0; v < u.size (); ++v)
+                {
+                  toBelow += std::fabs (u[v] - below[v]);
+                  toAbove += std::fabs (u[v] - above[v]);
+                }
+              width *= 2;
+              if (toBelow <= toAbove)
+                {
+                  if (high >= maxLoad)
+                    {
+                      found = false;
+                      break;
+                    }
+                  low = high;
+                  high = std::min (maxLoad, high + width);
+                }
+              else
+                {
+                  if (low <= minLoad)
+                    {
+                      found = false;
+                      break;
+                    }
+                  high = low;
+                  low = std::max (minLoad, low - width);
+                }
+            }
+          if (found)
+            {
+              RefineThreshold (runner, rest, low, high, resolution, victims, skipRows, nextIndex, evaluated, log);
+            }
+          else
+            {
+              // the bracket walked out of the range: search it all, as for the first row
+              std::pair<double, double> interval = BisectThreshold (runner, rest, minLoad, maxLoad, coarseStep, resolution,
+                                                                    victims, skipRows, nextIndex, evaluated, log);
+              low = interval.first;
+              high = interval.second;
+              double from = low;
+              double to = high;
+              found = SteepestInterval (evaluated, from, to) >= minJump;
+            }
+        }
+
+      if (!found)
+        {
+          std::cout << " no cascade threshold in [" << minLoad << ", " << maxLoad << "] for rest node = " << rest << std::endl;
+          continue;
+        }
+      std::cout << " rest node = " << rest << ": cascade threshold in [" << low << ", " << high << "]" << std::endl;
+      boundary << rest << " " << low << " " << high << std::endl;
+      traced.push_back (std::make_pair (rest, (low + high) / 2));
+      below = evaluated[low];
+      above = evaluated[high];
+    }
+}
+
+
+
+/*
+ * Probability that the cascade front crosses each splitting level within the
+ * run, from the records of the trajectories of every root (one root per
+ * replication). The roots are independent, which gives the confidence
+ * intervals. The estimates are written to cascade.txt in the folder of the
+ * point, one line per level: "<node> <probability> <95% half-width> <roots>".
+ */
+void EstimateCascadeProbability (std::string const &outputRoot, SweepPoint const &point, uint32_t replications,
+                                 std::vector<uint32_t> const &levels)
+{
+  std::vector<uint32_t> runs;
+  for (uint32_t run = (replications > 1 ? 1 : 0); run <= (replications > 1 ? replications : 0); ++run)
+    {
+      runs.push_back (run);
+    }
+  std::vector<std::vector<double> > probability (levels.size (), std::vector<double> (runs.size (), 0));
+  for (size_t k = 0; k < runs.size (); ++k)
+    {
+      std::string filename = PointDirectory (ReplicationRoot (outputRoot, runs[k]), point.firstNodeLoad, point.restNodeLoad)
+        + "/splitting.txt";
+      std::ifstream in (filename.c_str ());
+      NS_ABORT_MSG_UNLESS (in.is_open (), "EstimateCascadeProbability: cannot open " << filename);
+      uint32_t crossed;
+      double weight, end;
+      while (in >> crossed >> weight >> end)
+        {
+          for (uint32_t j = 0; j < crossed && j < levels.size (); ++j)
+            {
+              probability[j][k] += weight;
+            }
+        }
+    }
+
+  std::ofstream out ((PointDirectory (outputRoot, point.firstNodeLoad, point.restNodeLoad) + "/cascade.txt").c_str ());
+  for (size_t j = 0; j < levels.size (); ++j)
+    {
+      double mean = 0;
+      for (size_t k = 0; k < runs.size (); ++k)
+        {
+          mean += probability[j][k];
+        }
+      mean /= runs.size ();
+      double halfWidth = std::numeric_limits<double>::infinity ();
+      if (runs.size () > 1)
+        {
+          double variance = 0;
+          for (size_t k = 0; k < runs.size (); ++k)
+            {
+              variance += (probability[j][k] - mean) * (probability[j][k] - mean);
+            }
+          variance /= runs.size () - 1;
+          halfWidth = StudentT95 (runs.size () - 1) * std::sqrt (variance / runs.size ());
+        }
+      std::cout << " P(cascade front reaches node " << levels[j] << ") = " << mean << " +/- " << halfWidth << std::endl;
+      out << levels[j] << " " << mean << " " << halfWidth << " " << runs.size () << std::endl;
+    }
+}
+
+
+/*
+ * Phase curve of the victims traced by the ramp, from the .segments files of
+ * every replication: ramp.txt holds one line per attacker load,
+ *   <load> <utilization going up, per victim> <utilization going down, per victim>
+ * averaged over the replications, nan where the ramp does not visit the load.
+ */
+void WriteRampCurve (std::string const &outputRoot, SweepPoint const &point, uint32_t replications,
+                     std::vector<uint32_t> const &victims)
+{
+  // (load, down) -> per victim sum of the utilization means and number of runs
+  std::map<std::pair<double, bool>, std::pair<std::vector<double>, uint32_t> > curve;
+  for (uint32_t run = (replications > 1 ? 1 : 0); run <= (replications > 1 ? replications : 0); ++run)
+    {
+      for (size_t v = 0; v < victims.size (); ++v)
+        {
+          std::ostringstream filename;
+          filename << PointDirectory (ReplicationRoot (outputRoot, run), point.firstNodeLoad, point.restNodeLoad)
+                   << "/nodes_" << std::setfill ('0') << std::setw (3) << victims[v] << "_000.segments";
+          std::ifstream in (filename.str ().c_str ());
+          NS_ABORT_MSG_UNLESS (in.is_open (), "WriteRampCurve: cannot open " << filename.str ());
+          double load, utilization, rxBytes;
+          std::string direction;
+          uint32_t first, rows;
+          while (in >> load >> direction >> first >> rows >> utilization >> rxBytes)
+            {
+              std::pair<std::vector<double>, uint32_t> &entry = curve[std::make_pair (load, direction == "down")];
+              entry.first.resize (victims.size (), 0);
+              entry.first[v] += utilization;
+              if (v == 0)
+                {
+                  ++entry.second;
+                }
+            }
+        }
+    }
+
+  std::ofstream out ((outputRoot + "/ramp.txt").c_str ());
+  std::vector<double> loads = RampLoads (point.firstNodeLoad);
+  for (size_t k = 0; k < (loads.size () + 1) / 2; ++k)
+    {
+      out << loads[k];
+      for (int down = 0; down < 2; ++down)
+        {
+          std::map<std::pair<double, bool>, std::pair<std::vector<double>, uint32_t> >::const_iterator it =
+            curve.find (std::make_pair (std::floor (loads[k] * 10000 + 0.5) / 10000, down == 1));
+          for (size_t v = 0; v < victims.size (); ++v)
+            {
+              if (it == curve.end () || it->second.second == 0)
+                {
+                  out << " nan";
+                }
+              else
+                {
+                  out << " " << it->second.first[v] / it->second.second;
+                }
+            }
+        }
+      out << std::endl;
+    }
+}
+
+
+//copy a directory tree, the COMPLETE manifest of a folder after all its other files
+void CopyTree (std::string const &from, std::string const &to)
+{
+  mkdir (to.c_str (), S_IRWXU | S_IRWXG | S_IRWXO);
+  DIR *dir = opendir (from.c_str ());
+  NS_ABORT_MSG_IF (dir == 0, "CopyTree: cannot open " << from);
+  std::vector<std::string> names;
+  for (struct dirent *entry = readdir (dir); entry != 0; entry = readdir (dir))
+    {
+      std::string name = entry->d_name;
+      if (name != "." && name != ".." && name != "COMPLETE")
+        {
+          names.push_back (name);
+        }
+    }
+  closedir (dir);
+  struct stat info;
+  if (stat ((from + "/COMPLETE").c_str (), &info) == 0)
+    {
+      names.push_back ("COMPLETE");
+    }
+  for (size_t i = 0; i < names.size (); ++i)
+    {
+      std::string source = from + "/" + names[i];
+      std::string target = to + "/" + names[i];
+      NS_ABORT_MSG_IF (stat (source.c_str (), &info) != 0, "CopyTree: cannot stat " << source);
+      if (S_ISDIR (info.st_mode))
+        {
+          CopyTree (source, target);
+          continue;
+        }
+      std::ifstream in (source.c_str (), std::ios_base::binary);
+      std::ofstream out (target.c_str (), std::ios_base::binary);
+      if (in.peek () != std::ifstream::traits_type::eof ())
+        {
+          out << in.rdbuf ();
+        }
+      NS_ABORT_MSG_UNLESS (out.good (), "CopyTree: cannot write " << target);
+    }
+}
+
+
+/*
+ * Combine the output folders of the shards of one sweep into outputRoot.
+ *
+ * Every shard_<index>_of_<count>.txt found in the folders is read. The merge
+ * is refused, before anything is copied, if a shard is missing or appears
+ * twice, if a job is listed by no shard or by several, or if the files of a
+ * job are missing or, with the cache, have no COMPLETE manifest. Otherwise
+ * the point folders and timing records are copied and the replications are
+ * summarized. Returns false when the merge was refused.
+ */
+bool MergeShards (std::vector<std::string> const &shardRoots, SweepRunner const &runner)
+{
+  std::string const &outputRoot = runner.GetOutputRoot ();
+  std::vector<std::string> problems;
+  uint32_t shardCount = 0;
+  uint32_t jobCount = 0;
+  std::map<uint32_t, std::string> shards;                              // shard index -> folder
+  std::map<uint32_t, std::pair<SweepPoint, std::string> > jobs;        // job index -> job, folder
+  uint32_t replications = 1;
+  char target [PATH_MAX];
+  bool targetExists = realpath (outputRoot.c_str (), target) != 0;
+  for (size_t k = 0; k < shardRoots.size (); ++k)
+    {
+      char source [PATH_MAX];
+      if (targetExists && realpath (shardRoots[k].c_str (), source) != 0 && std::string (source) == target)
+        {
+          problems.push_back (shardRoots[k] + " is the merge destination");
+          continue;
+        }
+      DIR *dir = opendir (shardRoots[k].c_str ());
+      if (dir == 0)
+        {
+          problems.push_back ("cannot open " + shardRoots[k]);
+          continue;
+        }
+      std::vector<std::string> manifests;
+      for (struct dirent *entry = readdir (dir); entry != 0; entry = readdir (dir))
+        {
+          std::string name = entry->d_name;
+          if (name.compare (0, 6, "shard_") == 0 && name.size () > 4 && name.compare (name.size () - 4, 4, ".txt") == 0)
+            {
+              manifests.push_back (shardRoots[k] + "/" + name);
+            }
+        }
+      closedir (dir);
+      if (manifests.empty ())
+        {
+          problems.push_back ("no shard manifest in " + shardRoots[k]);
+        }
+
+      for (size_t m = 0; m < manifests.size (); ++m)
+        {
+          std::ifstream in (manifests[m].c_str ());
+          std::string shardWord, jobsWord, replicationsWord, cacheWord;
+          uint32_t index, count, total, runs;
+          bool cache;
+          if (!(in >> shardWord >> index >> count >> jobsWord >> total >> replicationsWord >> runs >> cacheWord >> cache))
+            {
+              problems.push_back ("cannot parse " + manifests[m]);
+              continue;
+            }
+          if (shardCount == 0)
+            {
+              shardCount = count;
+              jobCount = total;
+              replications = runs;
+            }
+          if (count != shardCount || total != jobCount || runs != replications)
+            {
+              problems.push_back (manifests[m] + " belongs to another sweep");
+              continue;
+            }
+          if (runs != runner.GetReplications ())
+            {
+              std::ostringstream oss;
+              oss << manifests[m] << " has " << runs << " replications per point, merge with --replications=" << runs;
+              problems.push_back (oss.str ());
+              continue;
+            }
+          if (shards.find (index) != shards.end ())
+            {
+              std::ostringstream oss;
+              oss << "shard " << index << " found in " << shards[index] << " and " << shardRoots[k];
+              problems.push_back (oss.str ());
+              continue;
+            }
+          shards[index] = shardRoots[k];
+
+          SweepPoint job;
+          while (in >> job.index >> job.run >> job.firstNodeLoad >> job.restNodeLoad)
+            {
+              std::ostringstream oss;
+              oss << "job " << job.index << " (first node = " << job.firstNodeLoad << " rest node = " << job.restNodeLoad
+                  << " run " << job.run << ")";
+              if (jobs.find (job.index) != jobs.end ())
+                {
+                  problems.push_back (oss.str () + " listed by " + jobs[job.index].second + " and " + shardRoots[k]);
+                  continue;
+                }
+              jobs[job.index] = std::make_pair (job, shardRoots[k]);
+              std::string folder = PointDirectory (ReplicationRoot (shardRoots[k], job.run), job.firstNodeLoad, job.restNodeLoad);
+              struct stat info;
+              if (stat (folder.c_str (), &info) != 0)
+                {
+                  problems.push_back (oss.str () + " has no folder in " + shardRoots[k]);
+                }
+              else if (cache && stat (CompleteFile (shardRoots[k], job).c_str (), &info) != 0)
+                {
+                  problems.push_back (oss.str () + " is incomplete in " + shardRoots[k]);
+                }
+            }
+        }
+    }
+  for (uint32_t index = 0; index < shardCount; ++index)
+    {
+      if (shards.find (index) == shards.end ())
+        {
+          std::ostringstream oss;
+          oss << "shard " << index << " of " << shardCount << " is missing";
+          problems.push_back (oss.str ());
+        }
+    }
+  for (uint32_t index = 0; index < jobCount; ++index)
+    {
+      if (jobs.find (index) == jobs.end ())
+        {
+          std::ostringstream oss;
+          oss << "job " << index << " is missing";
+          problems.push_back (oss.str ());
+        }
+    }
+  if (shardCount == 0 || !problems.empty ())
+    {
+      for (size_t i = 0; i < problems.size (); ++i)
+        {
+          std::cerr << " " << problems[i] << std::endl;
+        }
+      std::cerr << " merge refused" << std::endl;
+      return false;
+    }
+
+  mkdir (outputRoot.c_str (), S_IRWXU | S_IRWXG | S_IRWXO);
+  std::vector<SweepPoint> points;
+  for (std::map<uint32_t, std::pair<SweepPoint, std::string> >::const_iterator it = jobs.begin (); it != jobs.end (); ++it)
+    {
+      SweepPoint const &job = it->second.first;
+      std::string const &from = it->second.second;
+      mkdir (ReplicationRoot (outputRoot, job.run).c_str (), S_IRWXU | S_IRWXG | S_IRWXO);
+      CopyTree (PointDirectory (ReplicationRoot (from, job.run), job.firstNodeLoad, job.restNodeLoad),
+                PointDirectory (ReplicationRoot (outputRoot, job.run), job.firstNodeLoad, job.restNodeLoad));
+      if (job.run <= 1)
+        {
+          SweepPoint point = job;
+          point.index = job.index / replications;
+          point.run = 0;
+          points.push_back (point);
+        }
+    }
+  std::set<std::string> roots;
+  for (std::map<uint32_t, std::string>::const_iterator it = shards.begin (); it != shards.end (); ++it)
+    {
+      roots.insert (it->second);
+    }
+  for (std::set<std::string>::const_iterator it = roots.begin (); it != roots.end (); ++it)
+    {
+      std::ifstream in ((*it + "/timing.txt").c_str ());
+      std::ofstream out ((outputRoot + "/timing.txt").c_str (), std::ios_base::app);
+      if (in.peek () != std::ifstream::traits_type::eof ())
+        {
+          out << in.rdbuf ();
+        }
+    }
+  runner.Summarize (points);
+  std::cout << " merged " << jobs.size () << " jobs of " << shardCount << " shards into " << outputRoot << std::endl;
+  return true;
+}
+
+
+//raise the soft limit on open files to the hard one: every athstats sink keeps its file open
+void RaiseOpenFileLimit (void)
+{
+  struct rlimit limit;
+  if (getrlimit (RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max)
+    {
+      limit.rlim_cur = limit.rlim_max;
+      setrlimit (RLIMIT_NOFILE, &limit);
+    }
+}
+
+
+//measurements of one chain length in the benchmark
+struct BenchmarkResult
+{
+  uint32_t nodes;
+  double simulated;       // simulated seconds
+  double install;         // wall seconds building the chain
+  double connect;         // wall seconds connecting the athstats trace sinks
+  double run;             // wall seconds running the simulation
+  double teardown;        // wall seconds destroying the chain
+  uint64_t events;        // events scheduled during the run
+  uint64_t peakRss;       // peak RSS of the process, kB
+};
+
+
+//does nothing; its scheduling gives the uid of the next event
+void BenchmarkNoop (void)
+{
+}
+
+
+//build, connect and run a chain of NumofNode nodes in a child process and measure the phases
+BenchmarkResult BenchmarkChain (uint16_t NumofNode, uint32_t DurationofSimulation, double FirstNodeLoad,
+                                double RestNodeLoad, std::string const &foldername, ExperimentOptions const &options)
+{
+  BenchmarkResult result = BenchmarkResult ();
+  int fds[2];
+  NS_ABORT_MSG_IF (pipe (fds) != 0, "BenchmarkChain: pipe () failed");
+  std::cout.flush ();
+  pid_t pid = fork ();
+  NS_ABORT_MSG_IF (pid < 0, "BenchmarkChain: fork () failed");
+  if (pid == 0)
+    {
+      close (fds[0]);
+      ResetPeakResident ();
+      result.nodes = NumofNode;
+      // every flow runs for DurationofSimulation seconds, whatever the length of the chain
+      result.simulated = (uint16_t)(3.100 + NumofNode/2*0.01) + 2 + DurationofSimulation;
+      double wall = WallClockSeconds ();
+      Chain chain;
+      BuildChain (false, NumofNode, FirstNodeLoad, RestNodeLoad, chain, options);
+      result.install = WallClockSeconds () - wall;
+      wall = WallClockSeconds ();
+      mkdir (foldername.c_str (), S_IRWXU | S_IRWXG | S_IRWXO);
+      chain.athstats.EnableAthstats (foldername + "/nodes", chain.devices);
+      result.connect = WallClockSeconds () - wall;
+      wall = WallClockSeconds ();
+      uint64_t first = Simulator::Schedule (Seconds (0), &BenchmarkNoop).GetUid ();
+      Simulator::Stop (Seconds (result.simulated));
+      Simulator::Run ();
+      result.events = Simulator::Schedule (Seconds (0), &BenchmarkNoop).GetUid () - first - 1;
+      result.run = WallClockSeconds () - wall;
+      result.peakRss = PeakResidentKilobytes ();
+      wall = WallClockSeconds ();
+      TeardownChain (chain);
+      result.teardown = WallClockSeconds () - wall;
+      ssize_t written = write (fds[1], &result, sizeof (result));
+      close (fds[1]);
+      _exit (written == sizeof (result) ? 0 : 1);
+    }
+  close (fds[1]);
+  ssize_t got = read (fds[0], &result, sizeof (result));
+  close (fds[0]);
+  int status;
+  waitpid (pid, &status, 0);
+  if (got != sizeof (result) || !WIFEXITED (status) || WEXITSTATUS (status) != 0)
+    {
+      std::cerr << " benchmark of " << NumofNode << " nodes failed" << std::endl;
+      result = BenchmarkResult ();
+      result.nodes = NumofNode;
+    }
+  return result;
+}
+
+
+/*
+ * Benchmark the chain for each node count, each one in a process of its own,
+ * and write the results to benchmark.json:
+ *   {"duration": <s>, "attackerLoad": <load>, "restNodeLoad": <load>, "neighbours": <bool>, "runs": [
+ *     {"nodes": <n>, "simulated_s": <s>, "install_s": <s>, "connect_s": <s>, "run_s": <s>,
+ *      "teardown_s": <s>, "events": <n>, "events_per_s": <rate>, "peak_rss_kb": <kB>}, ...]}
+ * A run that failed, for instance out of memory, has zero times.
+ */
+void RunBenchmark (std::vector<uint32_t> const &nodeCounts, uint32_t DurationofSimulation, double FirstNodeLoad,
+                   double RestNodeLoad, std::string const &outputRoot, ExperimentOptions const &options)
+{
+  RaiseOpenFileLimit ();
+  mkdir (outputRoot.c_str (), S_IRWXU | S_IRWXG | S_IRWXO);
+  mkdir ((outputRoot + "/benchmark").c_str (), S_IRWXU | S_IRWXG | S_IRWXO);
+  std::ofstream out ((outputRoot + "/benchmark.json").c_str ());
+  out << "{\"duration\": " << DurationofSimulation << ", \"attackerLoad\": " << FirstNodeLoad
+      << ", \"restNodeLoad\": " << RestNodeLoad << ", \"neighbours\": " << (options.neighbours ? "true" : "false")
+      << ", \"runs\": [";
+  std::cout << "  nodes  install (s)  connect (s)  run (s)   events/s  peak RSS (MB)" << std::endl;
+  for (size_t k = 0; k < nodeCounts.size (); ++k)
+    {
+      NS_ABORT_MSG_IF (nodeCounts[k] < 2 || nodeCounts[k] % 2 != 0 || nodeCounts[k] > 65534,
+                       "RunBenchmark: a chain has an even number of nodes, from 2 to 65534");
+      char folder [64];
+      snprintf (folder, sizeof (folder), "/benchmark/%05u", nodeCounts[k]);
+      BenchmarkResult result = BenchmarkChain (nodeCounts[k], DurationofSimulation, FirstNodeLoad, RestNodeLoad,
+                                               outputRoot + folder, options);
+      double rate = result.run > 0 ? result.events / result.run : 0;
+      char line [512];
+      snprintf (line, sizeof (line), "%s\n  {\"nodes\": %u, \"simulated_s\": %.0f, \"install_s\": %.6f, \"connect_s\": %.6f, "
+                "\"run_s\": %.6f, \"teardown_s\": %.6f, \"events\": %llu, \"events_per_s\": %.0f, \"peak_rss_kb\": %llu}",
+                k > 0 ? "," : "", result.nodes, result.simulated, result.install, result.connect, result.run,
+                result.teardown, (unsigned long long) result.events, rate, (unsigned long long) result.peakRss);
+      out << line;
+      out.flush ();
+      snprintf (line, sizeof (line), " %6u %12.2f %12.2f %8.1f %10.0f %14.1f", result.nodes, result.install,
+                result.connect, result.run, rate, result.peakRss / 1024.0);
+      std::cout << line << std::endl;
+    }
+  out << "\n]}" << std::endl;
+}
+
+
+int main (int argc, char **argv){
+  //Packet::EnablePrinting ();
+  uint32_t workers = 1;
+  std::string outputRoot = "./CDoS-1Mbps-adhoc-UDP-01";
+  uint16_t pilotDuration = 0;
+  std::string mode = "grid";
+  std::string victimList = "0";
+  double restLoad = 0.13;
+  double coarseStep = 0.1;
+  double resolution = 0.005;
+  uint32_t warmupRows = 0;
+  double restMin = 0.05;
+  double restMax = 0.20;
+  double restStep = 0.01;
+  double bracketWidth = 0.06;
+  double minJump = 0.1;
+  uint32_t replications = 1;
+  bool cache = true;
+  uint32_t shardIndex = 0;
+  uint32_t shardCount = 1;
+  std::string shardList = "";
+  ExperimentOptions options;
+  std::string ciNodeList = "";
+  bool progress = false;
+  double attackerLoad = 0.3;
+  uint32_t rampDwell = 60;
+  std::string levelList = "70,60,50,40,30,20,10,0";
+  std::string benchmarkNodeList = "82,250,500,1000,2500,5000,10000";
+  uint32_t benchmarkDuration = 10;
+  options.progressInterval = 10;
+  CommandLine cmd;
+  cmd.AddValue ("workers", "Number of worker processes running sweep points in parallel (1 runs the sweep serially)", workers);
+  cmd.AddValue ("outputRoot", "Folder receiving one sub-folder per sweep point", outputRoot);
+  cmd.AddValue ("replications", "Number of independent runs (RngRun 1, 2, ...) of every sweep point, summarized per node "
+                "in summary.txt (1 runs the default RngRun once)", replications);
+  cmd.AddValue ("cache", "Skip the points whose COMPLETE manifest records the same inputs (0 simulates every point again)", cache);
+  cmd.AddValue ("shardIndex", "grid: index of the shard of the sweep run by this host, from 0 to shardCount - 1", shardIndex);
+  cmd.AddValue ("shardCount", "grid: number of hosts sharing the sweep, each one running the points whose index modulo "
+                "shardCount is its shardIndex", shardCount);
+  cmd.AddValue ("shards", "merge: comma-separated output folders of the shards, combined into outputRoot", shardList);
+  cmd.AddValue ("progressInterval", "Wall seconds between two updates of status.txt in outputRoot (0 disables them)",
+                options.progressInterval);
+  cmd.AddValue ("progress", "Print the progress reports to stderr as well", progress);
+  cmd.AddValue ("pilotDuration", "Simulated seconds of the pilot runs estimating the cost of points without timing records (0 disables pilots)", pilotDuration);
+  cmd.AddValue ("mode", "Sweep mode: grid (the 49 attacker loads), bisect (adaptive search of the cascade threshold) "
+                "contour (trace the threshold across rest node loads), splitting (probability of a cascade "
+                "reaching node 0 at one attacker load), ramp (attacker load stepped up and down in one run), merge (combine "
+                "the folders of the shards of a grid sweep) or benchmark (time chains of growing length)", mode);
+  cmd.AddValue ("victims", "bisect/contour/ramp: comma-separated ids of the sender nodes whose utilization is tracked", victimList);
+  cmd.AddValue ("restNodeLoad", "bisect/splitting/ramp/benchmark: load of the nodes other than the attacker", restLoad);
+  cmd.AddValue ("attackerLoad", "splitting/benchmark: load of the attacker", attackerLoad);
+  cmd.AddValue ("benchmarkNodes", "benchmark: comma-separated even node counts of the chains", benchmarkNodeList);
+  cmd.AddValue ("benchmarkDuration", "benchmark: simulated seconds after the last flow of a chain has started", benchmarkDuration);
+  cmd.AddValue ("levels", "splitting: comma-separated senders whose utilization marks the progress of the cascade front, "
+                "the last one being the rare event", levelList);
+  cmd.AddValue ("splitFactor", "splitting: copies of a trajectory crossing a level", options.splitFactor);
+  cmd.AddValue ("frontUtilization", "splitting: utilization of a sender reached by the cascade front", options.frontUtilization);
+  cmd.AddValue ("frontWindow", "splitting: one-second reports averaged into the utilization of a level", options.frontWindow);
+  cmd.AddValue ("rampStep", "ramp: attacker load step", options.rampStep);
+  cmd.AddValue ("dwell", "ramp: seconds spent at each attacker load", rampDwell);
+  cmd.AddValue ("settle", "ramp: leading seconds of each attacker load left out of its statistics", options.rampSettle);
+  cmd.AddValue ("coarseStep", "bisect/contour: step of the coarse pass over the attacker load", coarseStep);
+  cmd.AddValue ("resolution", "bisect/contour: width of the attacker load interval at which the search stops", resolution);
+  cmd.AddValue ("restMin", "contour: first rest node load", restMin);
+  cmd.AddValue ("restMax", "contour: last rest node load", restMax);
+  cmd.AddValue ("restStep", "contour: rest node load step between boundary points", restStep);
+  cmd.AddValue ("bracketWidth", "contour: width of the attacker load bracket simulated around the extrapolated boundary", bracketWidth);
+  cmd.AddValue ("minJump", "contour: victim utilization change showing that a bracket contains the transition", minJump);
+  cmd.AddValue ("warmupRows", "Number of one-second rows discarded before averaging the utilization "
+                "(0 uses the warm-up detected by the athstats trace sinks)", warmupRows);
+  cmd.AddValue ("ciPrecision", "Relative half-width of the 95% confidence intervals at which a point stops "
+                "before the full duration (0 always simulates the full duration)", options.ciPrecision);
+  cmd.AddValue ("ciBatches", "Number of batch means in the confidence intervals", options.ciBatches);
+  cmd.AddValue ("ciNodes", "Comma-separated ids of the sender nodes whose utilization and receiver throughput "
+                "must meet the precision (empty: all senders)", ciNodeList);
+  cmd.AddValue ("snapshot", "Simulate the warm-up shared by the points of a sweep once and fork every point from it "
+                "(results differ from the default runs, which rebuild each point)", options.snapshot);
+  cmd.AddValue ("profile", "Count the events and wall time of every event handler on every node, written to profile.txt "
+                "in the folder of each point", options.profile);
+  cmd.AddValue ("reuse", "Build the chain once and run the points of a sweep one after the other on it, resetting "
+                "it in between (results differ from the default runs, which rebuild each point)", options.reuse);
+  cmd.AddValue ("neighbours", "Deliver each frame only to the nodes that receive it above "
+                "ns3::YansWifiChannel::NeighbourThreshold (needs the modified yans-wifi-channel)", options.neighbours);
+  cmd.AddValue ("linkCache", "Compute the delay and received power of every link once rather than at every frame "
+                "(needs the modified yans-wifi-channel, results are unchanged)", options.linkCache);
+  cmd.AddValue ("culling", "Ignore the signals received this many dB below the noise floor, and report the culled "
+                "signals and the worst-case SINR error in culling.txt (needs the modified yans-wifi-phy, 0 disables)",
+                options.culling);
+  cmd.AddValue ("perTable", "Read the chunk success rates from lookup tables interpolated to within this error "
+                "of the error rate model (needs the modified interference-helper, 0 disables)", options.perTable);
+  cmd.AddValue ("crn", "Common random numbers: give the background senders, phys, MACs and internet stacks "
+                "the same random streams at every sweep point, only the attacker's streams differ", options.crn);
+  cmd.Parse (argc, argv);
+  options.ciNodes = ParseNodeList (ciNodeList);
+  options.progressStderr = progress;
+  if (options.profile)
+    {
+      GlobalValue::Bind ("SimulatorImplementationType", StringValue ("ProfilingSimulatorImpl"));
+    }
+  if (mode == "splitting")
+    {
+      options.levels = ParseNodeList (levelList);
+      NS_ABORT_MSG_IF (options.levels.empty (), "--mode=splitting needs at least one level");
+    }
+  if (mode == "ramp")
+    {
+      NS_ABORT_MSG_UNLESS (options.rampStep > 0 && options.rampStep <= 0.5, "--rampStep must lie in (0, 0.5]");
+      NS_ABORT_MSG_UNLESS (rampDwell > options.rampSettle, "--dwell must be longer than --settle");
+      options.rampDwell = rampDwell;
+    }
+
+  RngSeedManager::SetSeed(1);
+  uint16_t numofnode = 82;
+  uint16_t durationofsimulation = 1003;
+  SweepRunner runner (false, numofnode, durationofsimulation, outputRoot, workers, pilotDuration, replications, options, cache);
+  NS_ABORT_MSG_IF (shardCount > 1 && mode != "grid", "only the grid sweep can be sharded");
+  runner.SetShard (shardIndex, shardCount);
+  if (mode == "merge")
+    {
+      return MergeShards (SplitList (shardList), runner) ? 0 : 1;
+    }
+  if (mode == "benchmark")
+    {
+      RunBenchmark (ParseNodeList (benchmarkNodeList), benchmarkDuration, attackerLoad, restLoad, outputRoot,
+                    options);
+      return 0;
+    }
+  if (mode == "bisect")
+    {
+      mkdir (outputRoot.c_str (), S_IRWXU | S_IRWXG | S_IRWXO);
+      uint32_t nextIndex = 0;
+      LoadResults evaluated;
+      std::ofstream log ((outputRoot + "/bisect.txt").c_str (), std::ios_base::app);
+      std::pair<double, double> threshold = BisectThreshold (runner, restLoad, 0.02, 0.98, coarseStep, resolution,
+                                                             ParseNodeList (victimList), warmupRows, nextIndex,
+                                                             evaluated, log);
+      std::cout << " cascade threshold in [" << threshold.first << ", " << threshold.second << "] after "
+                << nextIndex << " points" << std::endl;
+      std::ofstream out ((outputRoot + "/threshold.txt").c_str (), std::ios_base::app);
+      out << restLoad << " " << threshold.first << " " << threshold.second << " " << nextIndex << std::endl;
+      return 0;
+    }
+  if (mode == "contour")
+    {
+      mkdir (outputRoot.c_str (), S_IRWXU | S_IRWXG | S_IRWXO);
+      uint32_t nextIndex = 0;
+      TraceBoundary (runner, restMin, restMax, restStep, 0.02, 0.98, coarseStep, bracketWidth, minJump, resolution,
+                     ParseNodeList (victimList), warmupRows, nextIndex);
+      std::cout << " boundary traced with " << nextIndex << " points" << std::endl;
+      return 0;
+    }
+  if (mode == "splitting")
+    {
+      SweepPoint point;
+      point.index = 0;
+      point.run = 0;
+      point.firstNodeLoad = attackerLoad;
+      point.restNodeLoad = restLoad;
+      runner.Run (std::vector<SweepPoint> (1, point));
+      EstimateCascadeProbability (outputRoot, point, replications, options.levels);
+      return 0;
+    }
+  if (mode == "ramp")
+    {
+      // one point named after the first load of the ramp, in a folder of its own
+      SweepPoint point;
+      point.index = 0;
+      point.run = 0;
+      point.firstNodeLoad = options.rampStep;
+      point.restNodeLoad = restLoad;
+      SweepRunner rampRunner (false, numofnode, RampDuration (numofnode, options.rampStep, options.rampDwell),
+                              outputRoot + "/ramp", workers, 0, replications, options, cache);
+      rampRunner.Run (std::vector<SweepPoint> (1, point));
+      WriteRampCurve (outputRoot + "/ramp", point, replications, ParseNodeList (victimList));
+      return 0;
+    }
+  NS_ABORT_MSG_UNLESS (mode == "grid", "unknown --mode=" << mode);
+
+  std::vector<SweepPoint> points;
   for (size_t i = 1; i < 50; ++i){
-    firstnodeload = (double)0.02*i;
     for (size_t j = 13; j<14; ++j){
-      restnodeload = (double)j/100;
-      std::cout << " first node = " << firstnodeload << " rest node = " << restnodeload << std::endl;
-      experiment (false, numofnode, durationofsimulation, firstnodeload, restnodeload);
+      SweepPoint point;
+      point.index = points.size ();
+      point.run = 0;
+      point.firstNodeLoad = (double)0.02*i;
+      point.restNodeLoad = (double)j/100;
+      points.push_back (point);
     }
   }
+  runner.Run (points);
   return 0;
 }
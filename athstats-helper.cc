@@ -24,8 +24,10 @@
 #include "ns3/simulator.h"
 #include "ns3/nstime.h"
 #include "ns3/config.h"
+#include "ns3/uinteger.h"
 #include "athstats-helper.h"
 #include <iomanip>
+#include <limits>
 #include <iostream>
 #include <fstream>
 
@@ -40,17 +42,24 @@ AthstatsHelper::AthstatsHelper ()
 {
 }
 
-void
-AthstatsHelper::EnableAthstats (std::string filename,  uint32_t nodeid, uint32_t deviceid)
+std::string
+AthstatsHelper::GetFilename (std::string filename, uint32_t nodeid, uint32_t deviceid)
 {
-  Ptr<AthstatsWifiTraceSink> athstats = CreateObject<AthstatsWifiTraceSink> ();
   std::ostringstream oss;
   oss << filename
       << "_" << std::setfill ('0') << std::setw (3) << std::right <<  nodeid
       << "_" << std::setfill ('0') << std::setw (3) << std::right << deviceid;
-  athstats->Open (oss.str ());
+  return oss.str ();
+}
+
+void
+AthstatsHelper::EnableAthstats (std::string filename,  uint32_t nodeid, uint32_t deviceid)
+{
+  Ptr<AthstatsWifiTraceSink> athstats = CreateObject<AthstatsWifiTraceSink> ();
+  m_sinks[std::make_pair (nodeid, deviceid)] = athstats;
+  athstats->Open (GetFilename (filename, nodeid, deviceid));
 
-	oss.str ("");
+  std::ostringstream oss;
 	oss << "/NodeList/" << nodeid << "/ApplicationList/*";
 	std::string applicationpath = oss.str ();
 	Config::Connect (applicationpath + "/Tx", MakeCallback (&AthstatsWifiTraceSink::AppTxTrace, athstats));
@@ -115,6 +124,69 @@ AthstatsHelper::EnableAthstats (std::string filename, NodeContainer n)
 }
 
 
+Ptr<AthstatsWifiTraceSink>
+AthstatsHelper::GetSink (uint32_t nodeid, uint32_t deviceid) const
+{
+  std::map<std::pair<uint32_t, uint32_t>, Ptr<AthstatsWifiTraceSink> >::const_iterator it =
+    m_sinks.find (std::make_pair (nodeid, deviceid));
+  if (it == m_sinks.end ())
+    {
+      return 0;
+    }
+  return it->second;
+}
+
+void
+AthstatsHelper::Flush (void)
+{
+  for (std::map<std::pair<uint32_t, uint32_t>, Ptr<AthstatsWifiTraceSink> >::iterator it = m_sinks.begin ();
+       it != m_sinks.end (); ++it)
+    {
+      it->second->Flush ();
+    }
+}
+
+void
+AthstatsHelper::Redirect (std::string filename)
+{
+  for (std::map<std::pair<uint32_t, uint32_t>, Ptr<AthstatsWifiTraceSink> >::iterator it = m_sinks.begin ();
+       it != m_sinks.end (); ++it)
+    {
+      it->second->Redirect (GetFilename (filename, it->first.first, it->first.second));
+    }
+}
+
+void
+AthstatsHelper::Detach (void)
+{
+  for (std::map<std::pair<uint32_t, uint32_t>, Ptr<AthstatsWifiTraceSink> >::iterator it = m_sinks.begin ();
+       it != m_sinks.end (); ++it)
+    {
+      it->second->Detach ();
+    }
+}
+
+void
+AthstatsHelper::StartSegment (std::string const &label, uint32_t settleRows)
+{
+  for (std::map<std::pair<uint32_t, uint32_t>, Ptr<AthstatsWifiTraceSink> >::iterator it = m_sinks.begin ();
+       it != m_sinks.end (); ++it)
+    {
+      it->second->StartSegment (label, settleRows);
+    }
+}
+
+void
+AthstatsHelper::Restart (std::string filename)
+{
+  for (std::map<std::pair<uint32_t, uint32_t>, Ptr<AthstatsWifiTraceSink> >::iterator it = m_sinks.begin ();
+       it != m_sinks.end (); ++it)
+    {
+      it->second->Restart (filename.empty () ? filename : GetFilename (filename, it->first.first, it->first.second));
+    }
+}
+
+
 
 
 
@@ -131,6 +203,11 @@ AthstatsWifiTraceSink::GetTypeId (void)
                    TimeValue (Seconds (1.0)),
                    MakeTimeAccessor (&AthstatsWifiTraceSink::m_interval),
                    MakeTimeChecker ())
+    .AddAttribute ("MserBatchSize",
+                   "Number of reports averaged into one batch by the MSER warm-up detection",
+                   UintegerValue (5),
+                   MakeUintegerAccessor (&AthstatsWifiTraceSink::m_mserBatchSize),
+                   MakeUintegerChecker<uint32_t> (1))
   ;
   return tid;
 }
@@ -150,8 +227,15 @@ AthstatsWifiTraceSink::AthstatsWifiTraceSink ()
 		//m_phyTxBeginSeg (0),
 		m_phyRate (0),
 		m_txDuration (0),
-    m_writer (0)
+    m_writer (0),
+    m_batchSum (0),
+    m_batchCount (0),
+    m_warmupBatches (0),
+    m_segmentOpen (false),
+    m_segmentStart (0),
+    m_segmentSettle (0)
 {
+  m_nextReport = Simulator::Now ();
   Simulator::ScheduleNow (&AthstatsWifiTraceSink::WriteStats, this);
 }
 
@@ -161,6 +245,9 @@ AthstatsWifiTraceSink::~AthstatsWifiTraceSink ()
 
   if (m_writer != 0)
     {
+      WriteWarmup ();
+      EndSegment ();
+      WriteSegments ();
       NS_LOG_LOGIC ("m_writer nonzero " << m_writer);
       if (m_writer->is_open ())
         {
@@ -319,6 +406,7 @@ AthstatsWifiTraceSink::Open (std::string const &name)
   NS_ABORT_MSG_UNLESS (m_writer, "AthstatsWifiTraceSink::Open (): Cannot allocate m_writer");
 
   NS_LOG_LOGIC ("Created writer " << m_writer);
+  m_name = name;
 
   m_writer->open (name.c_str (), std::ios_base::binary | std::ios_base::out);
   NS_ABORT_MSG_IF (m_writer->fail (), "AthstatsWifiTraceSink::Open (): m_writer->open (" << name.c_str () << ") failed");
@@ -328,6 +416,123 @@ AthstatsWifiTraceSink::Open (std::string const &name)
   NS_LOG_LOGIC ("Writer opened successfully");
 }
 
+void
+AthstatsWifiTraceSink::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_writer != 0)
+    {
+      m_writer->flush ();
+    }
+}
+
+void
+AthstatsWifiTraceSink::Redirect (std::string const &name)
+{
+  NS_LOG_FUNCTION (this << name);
+  NS_ABORT_MSG_UNLESS (m_writer != 0, "AthstatsWifiTraceSink::Redirect (): no file open");
+
+  m_writer->close ();
+  delete m_writer;
+  m_writer = 0;
+
+  std::ifstream previous (m_name.c_str (), std::ios_base::binary);
+  Open (name);
+  if (previous.peek () != std::ifstream::traits_type::eof ())
+    {
+      *m_writer << previous.rdbuf ();
+    }
+}
+
+void
+AthstatsWifiTraceSink::Detach (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ABORT_MSG_UNLESS (m_writer != 0, "AthstatsWifiTraceSink::Detach (): no file open");
+
+  // the closed stream keeps WriteStats scheduled and silently drops the reports
+  m_writer->close ();
+  m_name = "";
+}
+
+void
+AthstatsWifiTraceSink::StartSegment (std::string const &label, uint32_t settleRows)
+{
+  NS_LOG_FUNCTION (this << label << settleRows);
+  if (m_nextReport == Simulator::Now ())
+    {
+      // the report due at this instant still covers the last interval: switch after it
+      Simulator::ScheduleNow (&AthstatsWifiTraceSink::StartSegment, this, label, settleRows);
+      return;
+    }
+  EndSegment ();
+  m_segmentOpen = true;
+  m_segmentLabel = label;
+  m_segmentStart = m_utilizationSeries.size ();
+  m_segmentSettle = settleRows;
+}
+
+void
+AthstatsWifiTraceSink::EndSegment (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (!m_segmentOpen)
+    {
+      return;
+    }
+  m_segmentOpen = false;
+  uint32_t rows = m_utilizationSeries.size () - m_segmentStart;
+  double utilization = 0;
+  double rxBytes = 0;
+  uint32_t count = 0;
+  for (uint32_t k = m_segmentStart + m_segmentSettle; k < m_utilizationSeries.size (); ++k)
+    {
+      utilization += m_utilizationSeries[k];
+      rxBytes += m_rxBytesSeries[k];
+      ++count;
+    }
+  if (count > 0)
+    {
+      utilization /= count;
+      rxBytes /= count;
+    }
+  std::ostringstream oss;
+  oss << m_segmentLabel << " " << m_segmentStart << " " << rows << " " << utilization << " " << rxBytes;
+  m_segments.push_back (oss.str ());
+}
+
+void
+AthstatsWifiTraceSink::Restart (std::string const &name)
+{
+  NS_LOG_FUNCTION (this << name);
+  NS_ABORT_MSG_UNLESS (m_writer != 0, "AthstatsWifiTraceSink::Restart (): no file open");
+
+  WriteWarmup ();
+  EndSegment ();
+  WriteSegments ();
+  m_writer->close ();
+  delete m_writer;
+  m_writer = 0;
+
+  ResetCounters ();
+  m_batchSum = 0;
+  m_batchCount = 0;
+  m_batchMeans.clear ();
+  m_warmupBatches = 0;
+  m_utilizationSeries.clear ();
+  m_rxBytesSeries.clear ();
+  m_segments.clear ();
+
+  if (name.empty ())
+    {
+      // as after Detach, the closed stream keeps WriteStats scheduled and silently drops the reports
+      m_writer = new std::ofstream ();
+      m_name = "";
+      return;
+    }
+  Open (name);
+}
+
 
 void
 AthstatsWifiTraceSink::WriteStats ()
@@ -369,12 +574,117 @@ AthstatsWifiTraceSink::WriteStats ()
 
       *m_writer << str;
 
+      m_utilizationSeries.push_back (m_txDuration / m_interval.GetSeconds ());
+      m_rxBytesSeries.push_back (m_apprxcount);
+      UpdateWarmup (m_utilizationSeries.back ());
       ResetCounters ();
+      m_nextReport = Simulator::Now () + m_interval;
       Simulator::Schedule (m_interval, &AthstatsWifiTraceSink::WriteStats, this);
     }
 }
 
 
+/*
+ * MSER (marginal standard error rule, White 1997) applied to batch means:
+ * the truncation point d minimizes
+ *
+ *   MSER(d) = sum_{j>d} (Z_j - mean_{j>d} Z)^2 / (n-d)^2
+ *
+ * over the first half of the n batch means Z_j. With 5-report batches this
+ * is the usual MSER-5. The statistic is recomputed from suffix sums after
+ * every completed batch, so the estimate is available while the simulation
+ * runs.
+ */
+void
+AthstatsWifiTraceSink::UpdateWarmup (double utilization)
+{
+  m_batchSum += utilization;
+  if (++m_batchCount < m_mserBatchSize)
+    {
+      return;
+    }
+  m_batchMeans.push_back (m_batchSum / m_batchCount);
+  m_batchSum = 0;
+  m_batchCount = 0;
+
+  uint32_t n = m_batchMeans.size ();
+  double sum = 0;
+  double sumSquares = 0;
+  double best = std::numeric_limits<double>::max ();
+  for (uint32_t d = n; d-- > 0; )
+    {
+      sum += m_batchMeans[d];
+      sumSquares += m_batchMeans[d] * m_batchMeans[d];
+      if (d > n / 2)
+        {
+          continue;
+        }
+      uint32_t kept = n - d;
+      double mser = (sumSquares - sum * sum / kept) / ((double) kept * kept);
+      if (mser <= best)
+        {
+          best = mser;
+          m_warmupBatches = d;
+        }
+    }
+}
+
+uint32_t
+AthstatsWifiTraceSink::GetWarmupRows (void) const
+{
+  return m_warmupBatches * m_mserBatchSize;
+}
+
+bool
+AthstatsWifiTraceSink::IsWarmupDetected (void) const
+{
+  return !m_batchMeans.empty () && m_warmupBatches < m_batchMeans.size () / 2;
+}
+
+std::vector<double> const &
+AthstatsWifiTraceSink::GetUtilizationSeries (void) const
+{
+  return m_utilizationSeries;
+}
+
+std::vector<double> const &
+AthstatsWifiTraceSink::GetRxBytesSeries (void) const
+{
+  return m_rxBytesSeries;
+}
+
+Time
+AthstatsWifiTraceSink::GetInterval (void) const
+{
+  return m_interval;
+}
+
+void
+AthstatsWifiTraceSink::WriteSegments () const
+{
+  if (m_name.empty () || m_segments.empty ())
+    {
+      return;
+    }
+  std::ofstream segments ((m_name + ".segments").c_str ());
+  for (size_t k = 0; k < m_segments.size (); ++k)
+    {
+      segments << m_segments[k] << std::endl;
+    }
+}
+
+void
+AthstatsWifiTraceSink::WriteWarmup () const
+{
+  if (m_name.empty ())
+    {
+      return;
+    }
+  std::ofstream warmup ((m_name + ".warmup").c_str ());
+  warmup << GetWarmupRows () << " "
+         << GetWarmupRows () * m_interval.GetSeconds () << " "
+         << (IsWarmupDetected () ? 1 : 0) << std::endl;
+}
 
 
 } // namespace ns3
@@ -22,6 +22,8 @@
 #define ATHSTATS_HELPER_H
 
 #include <string>
+#include <vector>
+#include <map>
 #include "ns3/object.h"
 #include "ns3/attribute.h"
 #include "ns3/object-factory.h"
@@ -36,6 +38,7 @@ namespace ns3 {
 
 
 class NetDevice;
+class AthstatsWifiTraceSink;
 
 /**
  * @brief create AthstatsWifiTraceSink instances and connect them to wifi devices
@@ -51,8 +54,52 @@ public:
   void EnableAthstats (std::string filename, NetDeviceContainer d);
   void EnableAthstats (std::string filename, NodeContainer n);
 
+  /**
+   * @param nodeid the id of the node
+   * @param deviceid the index of the device on the node
+   * @return the trace sink enabled on that device, or 0 if there is none
+   */
+  Ptr<AthstatsWifiTraceSink> GetSink (uint32_t nodeid, uint32_t deviceid) const;
+
+  /**
+   * Write the buffered reports of every sink to its file.
+   */
+  void Flush (void);
+
+  /**
+   * Continue the reports of every sink in the files of a new prefix, which
+   * start as copies of the reports written so far.
+   *
+   * @param filename the prefix passed to EnableAthstats for the new files
+   */
+  void Redirect (std::string filename);
+
+  /**
+   * Stop writing the reports of every sink, which keep their series in memory.
+   */
+  void Detach (void);
+
+  /**
+   * Start a new segment of the reports of every sink.
+   *
+   * @param label the label of the segment in the .segments files
+   * @param settleRows the number of leading reports of the segment left out of its statistics
+   */
+  void StartSegment (std::string const &label, uint32_t settleRows);
+
+  /**
+   * Finish the reports of every sink and start new ones, from a clear state.
+   *
+   * @param filename the prefix passed to EnableAthstats for the new files, or
+   * an empty string to drop the reports until the next Restart
+   */
+  void Restart (std::string filename);
+
 private:
+  static std::string GetFilename (std::string filename, uint32_t nodeid, uint32_t deviceid);
+
   Time m_interval;
+  std::map<std::pair<uint32_t, uint32_t>, Ptr<AthstatsWifiTraceSink> > m_sinks;
 };
 
 
@@ -199,6 +246,87 @@ public:
    */
   void Open (std::string const& name);
 
+  /**
+   * Write the buffered reports to the file.
+   */
+  void Flush (void);
+
+  /**
+   * Copy the reports written so far to a new file and continue writing
+   * there. The sink must have been flushed before the process forked, so
+   * that the buffer does not hold reports of the previous file.
+   *
+   * @param name the name of the new file
+   */
+  void Redirect (std::string const& name);
+
+  /**
+   * Stop writing reports and the warm-up file, but keep updating the series
+   * and the warm-up estimate. As with Redirect, the sink must have been
+   * flushed before the process forked.
+   */
+  void Detach (void);
+
+  /**
+   * Close the current segment, if any, and open a new one with the next
+   * report covering time after now; a report due at this very instant
+   * covers the last interval, so the switch waits until it is written.
+   * The segments are summarized in <file>.segments, one line each:
+   * "<label> <first row> <rows> <utilization mean> <rx bytes mean>", the
+   * means being taken over the rows past the first settleRows.
+   *
+   * @param label the label of the segment
+   * @param settleRows the number of leading reports left out of the means
+   */
+  void StartSegment (std::string const &label, uint32_t settleRows);
+
+  /**
+   * Close the current segment, if any.
+   */
+  void EndSegment (void);
+
+  /**
+   * Write the warm-up and segment files of the current report and close it,
+   * clear the counters, series, warm-up estimate and segments, and start a
+   * new report, as if the sink had just been created. The reports keep their
+   * schedule, so the first row of the new file covers the time since the last
+   * report.
+   *
+   * @param name the name of the new file, or an empty string to drop the
+   * reports until the next Restart
+   */
+  void Restart (std::string const& name);
+
+  /**
+   * Number of leading report rows that belong to the initial transient, as
+   * currently estimated by the MSER rule on the utilization series.
+   *
+   * @return the number of rows to discard, zero before the first batch is complete
+   */
+  uint32_t GetWarmupRows (void) const;
+
+  /**
+   * @return true if the truncation point minimizing the MSER statistic lies
+   * in the first half of the series, i.e. the run is long enough for the
+   * estimate to be trusted
+   */
+  bool IsWarmupDetected (void) const;
+
+  /**
+   * @return the utilization (column 9) of every report written so far
+   */
+  std::vector<double> const &GetUtilizationSeries (void) const;
+
+  /**
+   * @return the application bytes received (column 2) in every report written so far
+   */
+  std::vector<double> const &GetRxBytesSeries (void) const;
+
+  /**
+   * @return the time interval between reports
+   */
+  Time GetInterval (void) const;
+
 private:
   /**
    * @internal
@@ -210,6 +338,29 @@ private:
    */
   void ResetCounters ();
 
+  /**
+   * @internal
+   *
+   * Add the utilization of the last interval to the series and, once a batch
+   * is complete, update the MSER truncation point.
+   */
+  void UpdateWarmup (double utilization);
+
+  /**
+   * @internal
+   *
+   * Record the truncation point next to the report file as
+   * "<rows to discard> <seconds to discard> <detected>".
+   */
+  void WriteWarmup () const;
+
+  /**
+   * @internal
+   *
+   * Write the summaries of the segments next to the report file.
+   */
+  void WriteSegments () const;
+
 	uint32_t m_apptxcount;
   uint32_t m_apprxcount;
   uint32_t m_txCount;
@@ -227,8 +378,25 @@ private:
 	double m_txDuration;
 
   std::ofstream *m_writer;
+  std::string m_name;
 
   Time m_interval;
+  Time m_nextReport;                   //!< time of the next report
+
+  uint32_t m_mserBatchSize;            //!< number of reports averaged into one MSER batch
+  double m_batchSum;                   //!< sum of the utilization reports of the current batch
+  uint32_t m_batchCount;               //!< number of reports in the current batch
+  std::vector<double> m_batchMeans;    //!< utilization batch means since the first report
+  uint32_t m_warmupBatches;            //!< batches discarded by the current MSER estimate
+
+  std::vector<double> m_utilizationSeries;   //!< column 9 of every report
+  std::vector<double> m_rxBytesSeries;       //!< column 2 of every report
+
+  bool m_segmentOpen;                  //!< whether StartSegment opened a segment not closed yet
+  std::string m_segmentLabel;          //!< label of the open segment
+  uint32_t m_segmentStart;             //!< first report of the open segment
+  uint32_t m_segmentSettle;            //!< reports of the open segment left out of its means
+  std::vector<std::string> m_segments; //!< summaries of the closed segments
 
 }; // class AthstatsWifiTraceSink
 
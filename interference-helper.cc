@@ -0,0 +1,768 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2005,2006 INRIA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
+ */
+#include "interference-helper.h"
+#include "wifi-phy.h"
+#include "error-rate-model.h"
+#include "ns3/simulator.h"
+#include "ns3/log.h"
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("InterferenceHelper");
+
+/****************************************************************
+ *       Phy event class
+ ****************************************************************/
+
+InterferenceHelper::Event::Event (uint32_t size, WifiMode payloadMode,
+                                  enum WifiPreamble preamble,
+                                  Time duration, double rxPower, WifiTxVector txVector)
+  : m_size (size),
+    m_payloadMode (payloadMode),
+    m_preamble (preamble),
+    m_startTime (Simulator::Now ()),
+    m_endTime (m_startTime + duration),
+    m_rxPowerW (rxPower),
+    m_txVector (txVector)
+{
+}
+InterferenceHelper::Event::~Event ()
+{
+}
+
+Time
+InterferenceHelper::Event::GetDuration (void) const
+{
+  return m_endTime - m_startTime;
+}
+Time
+InterferenceHelper::Event::GetStartTime (void) const
+{
+  return m_startTime;
+}
+Time
+InterferenceHelper::Event::GetEndTime (void) const
+{
+  return m_endTime;
+}
+double
+InterferenceHelper::Event::GetRxPowerW (void) const
+{
+  return m_rxPowerW;
+}
+uint32_t
+InterferenceHelper::Event::GetSize (void) const
+{
+  return m_size;
+}
+WifiMode
+InterferenceHelper::Event::GetPayloadMode (void) const
+{
+  return m_payloadMode;
+}
+enum WifiPreamble
+InterferenceHelper::Event::GetPreambleType (void) const
+{
+  return m_preamble;
+}
+
+WifiTxVector
+InterferenceHelper::Event::GetTxVector (void) const
+{
+  return m_txVector;
+}
+
+
+/****************************************************************
+ *       Class which records SNIR change events for a
+ *       short period of time.
+ ****************************************************************/
+
+InterferenceHelper::NiChange::NiChange (Time time, double delta)
+  : m_time (time),
+    m_delta (delta),
+    m_level (0.0)
+{
+}
+Time
+InterferenceHelper::NiChange::GetTime (void) const
+{
+  return m_time;
+}
+double
+InterferenceHelper::NiChange::GetDelta (void) const
+{
+  return m_delta;
+}
+double
+InterferenceHelper::NiChange::GetLevel (void) const
+{
+  return m_level;
+}
+void
+InterferenceHelper::NiChange::SetLevel (double level)
+{
+  m_level = level;
+}
+bool
+InterferenceHelper::NiChange::operator < (const InterferenceHelper::NiChange& o) const
+{
+  return (m_time < o.m_time);
+}
+
+/****************************************************************
+ *       Lookup table of the chunk success rates of a mode
+ ****************************************************************/
+
+// SNR nodes: PER_TABLE_SNR_STEPS per octave, from 2^PER_TABLE_MIN_SNR_EXP
+// (-36 dB) up to 2^PER_TABLE_MAX_SNR_EXP (72 dB)
+static const int PER_TABLE_MIN_SNR_EXP = -12;
+static const int PER_TABLE_MAX_SNR_EXP = 24;
+static const int PER_TABLE_SNR_STEPS = 32;
+// length nodes: PER_TABLE_BITS_STEPS per octave, from 2^PER_TABLE_MIN_BITS_EXP
+// bits up to 2^PER_TABLE_MAX_BITS_EXP bits, all whole numbers of bits, as
+// are the middles of the cells
+static const int PER_TABLE_MIN_BITS_EXP = 4;
+static const int PER_TABLE_MAX_BITS_EXP = 17;
+static const int PER_TABLE_BITS_STEPS = 8;
+static const uint32_t PER_TABLE_SNR_NODES = (PER_TABLE_MAX_SNR_EXP - PER_TABLE_MIN_SNR_EXP) * PER_TABLE_SNR_STEPS + 1;
+static const uint32_t PER_TABLE_BITS_NODES = (PER_TABLE_MAX_BITS_EXP - PER_TABLE_MIN_BITS_EXP) * PER_TABLE_BITS_STEPS + 1;
+
+InterferenceHelper::PerTable::PerTable (Ptr<ErrorRateModel> model, WifiMode mode, double tolerance)
+  : m_mode (mode),
+    m_csr (PER_TABLE_SNR_NODES * PER_TABLE_BITS_NODES),
+    m_exact ((PER_TABLE_SNR_NODES - 1) * (PER_TABLE_BITS_NODES - 1), false)
+{
+  for (uint32_t a = 0; a < PER_TABLE_SNR_NODES; a++)
+    {
+      for (uint32_t b = 0; b < PER_TABLE_BITS_NODES; b++)
+        {
+          m_csr[a * PER_TABLE_BITS_NODES + b] = model->GetChunkSuccessRate (mode, GetSnr (a), GetBits (b));
+        }
+    }
+  // the error of an interpolation is largest about the middles, where it is
+  // checked with a margin of half the tolerance
+  uint32_t nExact = 0;
+  double maxError = 0.0;
+  for (uint32_t a = 0; a + 1 < PER_TABLE_SNR_NODES; a++)
+    {
+      for (uint32_t b = 0; b + 1 < PER_TABLE_BITS_NODES; b++)
+        {
+          double const *csr = &m_csr[a * PER_TABLE_BITS_NODES + b];
+          double center = (csr[0] + csr[1] + csr[PER_TABLE_BITS_NODES] + csr[PER_TABLE_BITS_NODES + 1]) / 4;
+          double error = std::fabs (center - model->GetChunkSuccessRate (mode, GetSnr (a + 0.5), GetBits (b + 0.5)));
+          error = std::max (error, std::fabs ((csr[0] + csr[PER_TABLE_BITS_NODES]) / 2
+                                              - model->GetChunkSuccessRate (mode, GetSnr (a + 0.5), GetBits (b))));
+          error = std::max (error, std::fabs ((csr[0] + csr[1]) / 2
+                                              - model->GetChunkSuccessRate (mode, GetSnr (a), GetBits (b + 0.5))));
+          if (error > tolerance / 2)
+            {
+              m_exact[a * (PER_TABLE_BITS_NODES - 1) + b] = true;
+              nExact++;
+            }
+          else
+            {
+              maxError = std::max (maxError, error);
+            }
+        }
+    }
+  NS_LOG_INFO ("PER table of " << mode << ": " << nExact << " of " << m_exact.size ()
+               << " cells left to the error rate model, largest checked error " << maxError);
+}
+
+double
+InterferenceHelper::PerTable::GetSnr (double u)
+{
+  int octave = (int)(u / PER_TABLE_SNR_STEPS);
+  return std::ldexp (1.0 + (u - octave * PER_TABLE_SNR_STEPS) / PER_TABLE_SNR_STEPS, octave + PER_TABLE_MIN_SNR_EXP);
+}
+
+uint32_t
+InterferenceHelper::PerTable::GetBits (double v)
+{
+  int octave = (int)(v / PER_TABLE_BITS_STEPS);
+  return (uint32_t)std::ldexp (1.0 + (v - octave * PER_TABLE_BITS_STEPS) / PER_TABLE_BITS_STEPS, octave + PER_TABLE_MIN_BITS_EXP);
+}
+
+double
+InterferenceHelper::PerTable::GetChunkSuccessRate (Ptr<ErrorRateModel> model, double snir, uint64_t nbits) const
+{
+  // x = m 2^e with m in [0.5, 1), so x lies (2m - 1) of the way along octave e - 1
+  int snrExp;
+  double snrMantissa = std::frexp (snir, &snrExp);
+  int bitsExp;
+  double bitsMantissa = std::frexp ((double)nbits, &bitsExp);
+  if (snir <= 0 || snrExp - 1 < PER_TABLE_MIN_SNR_EXP || snrExp - 1 >= PER_TABLE_MAX_SNR_EXP
+      || nbits == 0 || bitsExp - 1 < PER_TABLE_MIN_BITS_EXP || bitsExp - 1 >= PER_TABLE_MAX_BITS_EXP)
+    {
+      return model->GetChunkSuccessRate (m_mode, snir, (uint32_t)nbits);
+    }
+  double u = (snrExp - 1 - PER_TABLE_MIN_SNR_EXP + 2 * snrMantissa - 1) * PER_TABLE_SNR_STEPS;
+  double v = (bitsExp - 1 - PER_TABLE_MIN_BITS_EXP + 2 * bitsMantissa - 1) * PER_TABLE_BITS_STEPS;
+  uint32_t a = (uint32_t)u;
+  uint32_t b = (uint32_t)v;
+  if (m_exact[a * (PER_TABLE_BITS_NODES - 1) + b])
+    {
+      return model->GetChunkSuccessRate (m_mode, snir, (uint32_t)nbits);
+    }
+  double fu = u - a;
+  double fv = v - b;
+  double const *csr = &m_csr[a * PER_TABLE_BITS_NODES + b];
+  return (csr[0] * (1 - fu) + csr[PER_TABLE_BITS_NODES] * fu) * (1 - fv)
+         + (csr[1] * (1 - fu) + csr[PER_TABLE_BITS_NODES + 1] * fu) * fv;
+}
+
+/****************************************************************
+ *       The actual InterferenceHelper
+ ****************************************************************/
+
+InterferenceHelper::InterferenceHelper ()
+  : m_errorRateModel (0),
+    m_perTableTolerance (0.0),
+    m_firstPower (0.0),
+    m_rxing (false)
+{
+}
+InterferenceHelper::~InterferenceHelper ()
+{
+  EraseEvents ();
+  m_errorRateModel = 0;
+}
+
+Ptr<InterferenceHelper::Event>
+InterferenceHelper::Add (uint32_t size, WifiMode payloadMode,
+                         enum WifiPreamble preamble,
+                         Time duration, double rxPowerW, WifiTxVector txVector)
+{
+  Ptr<InterferenceHelper::Event> event;
+
+  event = Create<InterferenceHelper::Event> (size,
+                                             payloadMode,
+                                             preamble,
+                                             duration,
+                                             rxPowerW,
+                                             txVector);
+  AppendEvent (event);
+  return event;
+}
+
+
+void
+InterferenceHelper::SetNoiseFigure (double value)
+{
+  m_noiseFigure = value;
+}
+
+double
+InterferenceHelper::GetNoiseFigure (void) const
+{
+  return m_noiseFigure;
+}
+
+void
+InterferenceHelper::SetErrorRateModel (Ptr<ErrorRateModel> rate)
+{
+  m_errorRateModel = rate;
+  m_perTables.clear ();
+}
+
+Ptr<ErrorRateModel>
+InterferenceHelper::GetErrorRateModel (void) const
+{
+  return m_errorRateModel;
+}
+
+void
+InterferenceHelper::SetPerTableTolerance (double tolerance)
+{
+  m_perTableTolerance = tolerance;
+  m_perTables.clear ();
+}
+
+double
+InterferenceHelper::GetPerTableTolerance (void) const
+{
+  return m_perTableTolerance;
+}
+
+Ptr<const InterferenceHelper::PerTable>
+InterferenceHelper::GetPerTable (WifiMode mode) const
+{
+  std::map<uint32_t, Ptr<const PerTable> >::const_iterator i = m_perTables.find (mode.GetUid ());
+  if (i != m_perTables.end ())
+    {
+      return i->second;
+    }
+  // the error rate models of ns-3 have no state, so the PHYs share the
+  // tables of a type of model
+  static std::map<std::string, Ptr<const PerTable> > tables;
+  std::ostringstream key;
+  key << m_errorRateModel->GetInstanceTypeId ().GetName () << " " << mode.GetUniqueName () << " " << m_perTableTolerance;
+  Ptr<const PerTable> &table = tables[key.str ()];
+  if (table == 0)
+    {
+      table = Create<PerTable> (m_errorRateModel, mode, m_perTableTolerance);
+    }
+  m_perTables[mode.GetUid ()] = table;
+  return table;
+}
+
+Time
+InterferenceHelper::GetEnergyDuration (double energyW)
+{
+  Time now = Simulator::Now ();
+  NiChanges::iterator i = std::lower_bound (m_niChanges.begin (), m_niChanges.end (), NiChange (now, 0.0));
+  // the changes at the present may be starts of signals
+  for (; i != m_niChanges.end () && i->GetTime () == now; i++)
+    {
+      if (i->GetLevel () < energyW)
+        {
+          return MicroSeconds (0);
+        }
+    }
+  if (i == m_niChanges.end ())
+    {
+      return MicroSeconds (0);
+    }
+  // the later ones are all ends, along which the energy decreases
+  NiChanges::iterator end = std::lower_bound (i, m_niChanges.end (), energyW, &InterferenceHelper::IsLevelAtLeast);
+  if (end == m_niChanges.end ())
+    {
+      end--;
+    }
+  return end->GetTime () - now;
+}
+
+void
+InterferenceHelper::AppendEvent (Ptr<InterferenceHelper::Event> event)
+{
+  Prune (GetPosition (Simulator::Now ()));
+  AddNiChangeEvent (NiChange (event->GetStartTime (), event->GetRxPowerW ()));
+  AddNiChangeEvent (NiChange (event->GetEndTime (), -event->GetRxPowerW ()));
+}
+
+
+double
+InterferenceHelper::CalculateSnr (double signal, double noiseInterference, WifiMode mode) const
+{
+  double noise = GetNoiseFloorW (mode) + noiseInterference;
+  double snr = signal / noise;
+  return snr;
+}
+
+double
+InterferenceHelper::GetNoiseFloorW (WifiMode mode) const
+{
+  // thermal noise at 290K in J/s = W
+  static const double BOLTZMANN = 1.3803e-23;
+  // Nt is the power of thermal noise in W
+  double Nt = BOLTZMANN * 290.0 * mode.GetBandwidth ();
+  // receiver noise Floor (W) which accounts for thermal noise and non-idealities of the receiver
+  return m_noiseFigure * Nt;
+}
+
+double
+InterferenceHelper::CalculateNoiseInterferenceW (Ptr<InterferenceHelper::Event> event, NiChanges *ni) const
+{
+  double noiseInterference = m_firstPower;
+  NS_ASSERT (m_rxing);
+  // the event starts at the first change, and the changes up to its end are
+  // kept as long as it is received
+  NiChanges::const_iterator end = std::lower_bound (m_niChanges.begin () + 1, m_niChanges.end (),
+                                                    NiChange (event->GetEndTime (), 0.0));
+  while (end != m_niChanges.end ()
+         && !((event->GetEndTime () == end->GetTime ()) && event->GetRxPowerW () == -end->GetDelta ()))
+    {
+      end++;
+    }
+  ni->insert (ni->end (), m_niChanges.begin () + 1, end);
+  ni->push_front (NiChange (event->GetStartTime (), noiseInterference));
+  ni->push_back (NiChange (event->GetEndTime (), 0));
+  return noiseInterference;
+}
+
+double
+InterferenceHelper::CalculateChunkSuccessRate (double snir, Time duration, WifiMode mode) const
+{
+  if (duration == NanoSeconds (0))
+    {
+      return 1.0;
+    }
+  uint32_t rate = mode.GetPhyRate ();
+  uint64_t nbits = (uint64_t)(rate * duration.GetSeconds ());
+  if (m_perTableTolerance > 0)
+    {
+      return GetPerTable (mode)->GetChunkSuccessRate (m_errorRateModel, snir, nbits);
+    }
+  double csr = m_errorRateModel->GetChunkSuccessRate (mode, snir, (uint32_t)nbits);
+  return csr;
+}
+
+double
+InterferenceHelper::CalculatePer (Ptr<const InterferenceHelper::Event> event, NiChanges *ni) const
+{
+  double psr = 1.0; /* Packet Success Rate */
+  NiChanges::iterator j = ni->begin ();
+  Time previous = (*j).GetTime ();
+  WifiMode payloadMode = event->GetPayloadMode ();
+  WifiPreamble preamble = event->GetPreambleType ();
+  WifiMode MfHeaderMode ;
+  if (preamble == WIFI_PREAMBLE_HT_MF)
+    {
+      MfHeaderMode = WifiPhy::GetMFPlcpHeaderMode (payloadMode, preamble); //return L-SIG mode
+    }
+  WifiMode headerMode = WifiPhy::GetPlcpHeaderMode (payloadMode, preamble);
+  Time plcpHeaderStart = (*j).GetTime () + MicroSeconds (WifiPhy::GetPlcpPreambleDurationMicroSeconds (payloadMode, preamble)); //packet start time+ preamble
+  Time plcpHsigHeaderStart = plcpHeaderStart + MicroSeconds (WifiPhy::GetPlcpHeaderDurationMicroSeconds (payloadMode, preamble)); //packet start time+ preamble+L SIG
+  Time plcpHtTrainingSymbolsStart = plcpHsigHeaderStart + MicroSeconds (WifiPhy::GetPlcpHtSigHeaderDurationMicroSeconds (payloadMode, preamble)); //packet start time+ preamble+L SIG+HT SIG
+  Time plcpPayloadStart = plcpHtTrainingSymbolsStart + MicroSeconds (WifiPhy::GetPlcpHtTrainingSymbolDurationMicroSeconds (payloadMode, preamble, event->GetTxVector ())); //packet start time+ preamble+L SIG+HT SIG+Training
+  double noiseInterferenceW = (*j).GetDelta ();
+  double powerW = event->GetRxPowerW ();
+  j++;
+  while (ni->end () != j)
+    {
+      Time current = (*j).GetTime ();
+      NS_ASSERT (current >= previous);
+      //Case 1: Both prev and curr point to the payload
+      if (previous >= plcpPayloadStart)
+        {
+          psr *= CalculateChunkSuccessRate (CalculateSnr (powerW,
+                                                          noiseInterferenceW,
+                                                          payloadMode),
+                                            current - previous,
+                                            payloadMode);
+        }
+      //Case 2: previous is in training or in SIG-B: non HT will not enter here since it didn't enter in the last two and they are all the same for non HT
+      else if (previous >= plcpHtTrainingSymbolsStart)
+        {
+          //Case 2a: current is after payload
+          if (current >= plcpPayloadStart)
+            {
+              //Case 2ai and 2aii: All formats
+              psr *= CalculateChunkSuccessRate (CalculateSnr (powerW,
+                                                              noiseInterferenceW,
+                                                              payloadMode),
+                                                current - plcpPayloadStart,
+                                                payloadMode);
+            }
+        }
+      //Case 3: previous is in HT-SIG: Non HT will not enter here since it didn't enter in the last two and they are all the same for non HT
+      else if (previous >= plcpHsigHeaderStart)
+        {
+          //Case 3a: current after payload start
+          if (current >= plcpPayloadStart)
+            {
+              psr *= CalculateChunkSuccessRate (CalculateSnr (powerW,
+                                                              noiseInterferenceW,
+                                                              payloadMode),
+                                                current - plcpPayloadStart,
+                                                payloadMode);
+
+              psr *= CalculateChunkSuccessRate (CalculateSnr (powerW,
+                                                              noiseInterferenceW,
+                                                              headerMode),
+                                                plcpHtTrainingSymbolsStart - previous,
+                                                headerMode);
+            }
+          //Case 3b: current is in HT training symbols
+          else if (current >= plcpHtTrainingSymbolsStart)
+            {
+              psr *= CalculateChunkSuccessRate (CalculateSnr (powerW,
+                                                              noiseInterferenceW,
+                                                              headerMode),
+                                                plcpHtTrainingSymbolsStart - previous,
+                                                headerMode);
+            }
+          //Case 3c: current is with previous in HT sig
+          else
+            {
+              psr *= CalculateChunkSuccessRate (CalculateSnr (powerW,
+                                                              noiseInterferenceW,
+                                                              headerMode),
+                                                current - previous,
+                                                headerMode);
+            }
+        }
+      //Case 4: previous in L-SIG: GF will not reach here because it will execute the previous if and exit
+      else if (previous >= plcpHeaderStart)
+        {
+          //Case 4a: current after payload start
+          if (current >= plcpPayloadStart)
+            {
+              psr *= CalculateChunkSuccessRate (CalculateSnr (powerW,
+                                                              noiseInterferenceW,
+                                                              payloadMode),
+                                                current - plcpPayloadStart,
+                                                payloadMode);
+              //Case 4ai: Non HT format (No HT-SIG or Training Symbols)
+              if (preamble == WIFI_PREAMBLE_LONG || preamble == WIFI_PREAMBLE_SHORT) //plcpHtTrainingSymbolsStart==plcpHeaderStart)
+                {
+                  psr *= CalculateChunkSuccessRate (CalculateSnr (powerW,
+                                                                  noiseInterferenceW,
+                                                                  headerMode),
+                                                    plcpPayloadStart - previous,
+                                                    headerMode);
+                }
+              else
+                {
+                  psr *= CalculateChunkSuccessRate (CalculateSnr (powerW,
+                                                                  noiseInterferenceW,
+                                                                  headerMode),
+                                                    plcpHtTrainingSymbolsStart - plcpHsigHeaderStart,
+                                                    headerMode);
+                  psr *= CalculateChunkSuccessRate (CalculateSnr (powerW,
+                                                                  noiseInterferenceW,
+                                                                  MfHeaderMode),
+                                                    plcpHsigHeaderStart - previous,
+                                                    MfHeaderMode);
+                }
+            }
+          //Case 4b: current in HT training symbol. non HT will not come here since it went in previous if or if the previous if is not true this will be not true
+          else if (current >= plcpHtTrainingSymbolsStart)
+            {
+              psr *= CalculateChunkSuccessRate (CalculateSnr (powerW,
+                                                              noiseInterferenceW,
+                                                              headerMode),
+                                                plcpHtTrainingSymbolsStart - plcpHsigHeaderStart,
+                                                headerMode);
+              psr *= CalculateChunkSuccessRate (CalculateSnr (powerW,
+                                                              noiseInterferenceW,
+                                                              MfHeaderMode),
+                                                plcpHsigHeaderStart - previous,
+                                                MfHeaderMode);
+            }
+          //Case 4c: current in H sig. non HT will not come here since it went in previous if or if the previous if is not true this will be not true
+          else if (current >= plcpHsigHeaderStart)
+            {
+              psr *= CalculateChunkSuccessRate (CalculateSnr (powerW,
+                                                              noiseInterferenceW,
+                                                              headerMode),
+                                                current - plcpHsigHeaderStart,
+                                                headerMode);
+              psr *= CalculateChunkSuccessRate (CalculateSnr (powerW,
+                                                              noiseInterferenceW,
+                                                              MfHeaderMode),
+                                                plcpHsigHeaderStart - previous,
+                                                MfHeaderMode);
+            }
+          //Case 4d: Current with prev in L SIG
+          else
+            {
+              //Case 4di: Non HT format (No HT-SIG or Training Symbols)
+              if (preamble == WIFI_PREAMBLE_LONG || preamble == WIFI_PREAMBLE_SHORT) //plcpHtTrainingSymbolsStart==plcpHeaderStart)
+                {
+                  psr *= CalculateChunkSuccessRate (CalculateSnr (powerW,
+                                                                  noiseInterferenceW,
+                                                                  headerMode),
+                                                    current - previous,
+                                                    headerMode);
+                }
+              else
+                {
+                  psr *= CalculateChunkSuccessRate (CalculateSnr (powerW,
+                                                                  noiseInterferenceW,
+                                                                  MfHeaderMode),
+                                                    current - previous,
+                                                    MfHeaderMode);
+                }
+            }
+        }
+      //Case 5: previous is in the preamble works for all cases
+      else
+        {
+          if (current >= plcpPayloadStart)
+            {
+              //for all
+              psr *= CalculateChunkSuccessRate (CalculateSnr (powerW,
+                                                              noiseInterferenceW,
+                                                              payloadMode),
+                                                current - plcpPayloadStart,
+                                                payloadMode);
+
+              // Non HT format (No HT-SIG or Training Symbols)
+              if (preamble == WIFI_PREAMBLE_LONG || preamble == WIFI_PREAMBLE_SHORT)
+                {
+                  psr *= CalculateChunkSuccessRate (CalculateSnr (powerW,
+                                                                  noiseInterferenceW,
+                                                                  headerMode),
+                                                    plcpPayloadStart - plcpHeaderStart,
+                                                    headerMode);
+                }
+              else
+                {
+                  // Greenfield or Mixed format
+                  psr *= CalculateChunkSuccessRate (CalculateSnr (powerW,
+                                                                  noiseInterferenceW,
+                                                                  headerMode),
+                                                    plcpHtTrainingSymbolsStart - plcpHsigHeaderStart,
+                                                    headerMode);
+                }
+              if (preamble == WIFI_PREAMBLE_HT_MF)
+                {
+                  psr *= CalculateChunkSuccessRate (CalculateSnr (powerW,
+                                                                  noiseInterferenceW,
+                                                                  MfHeaderMode),
+                                                    plcpHsigHeaderStart - plcpHeaderStart,
+                                                    MfHeaderMode);
+                }
+            }
+          else if (current >= plcpHtTrainingSymbolsStart)
+            {
+              // Non HT format will not come here since it will execute prev if
+              // Greenfield or Mixed format
+              psr *= CalculateChunkSuccessRate (CalculateSnr (powerW,
+                                                              noiseInterferenceW,
+                                                              headerMode),
+                                                plcpHtTrainingSymbolsStart - plcpHsigHeaderStart,
+                                                headerMode);
+              if (preamble == WIFI_PREAMBLE_HT_MF)
+                {
+                  psr *= CalculateChunkSuccessRate (CalculateSnr (powerW,
+                                                                  noiseInterferenceW,
+                                                                  MfHeaderMode),
+                                                    plcpHsigHeaderStart - plcpHeaderStart,
+                                                    MfHeaderMode);
+                }
+            }
+          //non HT will not come here
+          else if (current >= plcpHsigHeaderStart)
+            {
+              psr *= CalculateChunkSuccessRate (CalculateSnr (powerW,
+                                                              noiseInterferenceW,
+                                                              headerMode),
+                                                current - plcpHsigHeaderStart,
+                                                headerMode);
+              if (preamble != WIFI_PREAMBLE_HT_GF)
+                {
+                  psr *= CalculateChunkSuccessRate (CalculateSnr (powerW,
+                                                                  noiseInterferenceW,
+                                                                  MfHeaderMode),
+                                                    plcpHsigHeaderStart - plcpHeaderStart,
+                                                    MfHeaderMode);
+                }
+            }
+          // GF will not come here
+          else if (current >= plcpHeaderStart)
+            {
+              if (preamble == WIFI_PREAMBLE_LONG || preamble == WIFI_PREAMBLE_SHORT)
+                {
+                  psr *= CalculateChunkSuccessRate (CalculateSnr (powerW,
+                                                                  noiseInterferenceW,
+                                                                  headerMode),
+                                                    current - plcpHeaderStart,
+                                                    headerMode);
+                }
+              else
+                {
+                  psr *= CalculateChunkSuccessRate (CalculateSnr (powerW,
+                                                                  noiseInterferenceW,
+                                                                  MfHeaderMode),
+                                                    current - plcpHeaderStart,
+                                                    MfHeaderMode);
+                }
+            }
+        }
+
+      noiseInterferenceW += (*j).GetDelta ();
+      previous = (*j).GetTime ();
+      j++;
+    }
+
+  double per = 1 - psr;
+  return per;
+}
+
+
+struct InterferenceHelper::SnrPer
+InterferenceHelper::CalculateSnrPer (Ptr<InterferenceHelper::Event> event)
+{
+  NiChanges ni;
+  double noiseInterferenceW = CalculateNoiseInterferenceW (event, &ni);
+  double snr = CalculateSnr (event->GetRxPowerW (),
+                             noiseInterferenceW,
+                             event->GetPayloadMode ());
+
+  /* calculate the SNIR at the start of the packet and accumulate
+   * all SNIR changes in the snir vector.
+   */
+  double per = CalculatePer (event, &ni);
+
+  struct SnrPer snrPer;
+  snrPer.snr = snr;
+  snrPer.per = per;
+  return snrPer;
+}
+
+void
+InterferenceHelper::EraseEvents (void)
+{
+  m_niChanges.clear ();
+  m_rxing = false;
+  m_firstPower = 0.0;
+}
+InterferenceHelper::NiChanges::iterator
+InterferenceHelper::GetPosition (Time moment)
+{
+  return std::upper_bound (m_niChanges.begin (), m_niChanges.end (), NiChange (moment, 0));
+
+}
+void
+InterferenceHelper::AddNiChangeEvent (NiChange change)
+{
+  NiChanges::iterator i = m_niChanges.insert (GetPosition (change.GetTime ()), change);
+  // only the ends of the signals on the air follow a change made now
+  double level = i == m_niChanges.begin () ? m_firstPower : (i - 1)->GetLevel ();
+  for (; i != m_niChanges.end (); i++)
+    {
+      level += i->GetDelta ();
+      i->SetLevel (level);
+    }
+}
+bool
+InterferenceHelper::IsLevelAtLeast (const NiChange &change, double energyW)
+{
+  return change.GetLevel () >= energyW;
+}
+void
+InterferenceHelper::Prune (NiChanges::iterator end)
+{
+  if (m_rxing || end == m_niChanges.begin ())
+    {
+      return;
+    }
+  m_firstPower = (end - 1)->GetLevel ();
+  m_niChanges.erase (m_niChanges.begin (), end);
+}
+void
+InterferenceHelper::NotifyRxStart ()
+{
+  m_rxing = true;
+}
+void
+InterferenceHelper::NotifyRxEnd ()
+{
+  m_rxing = false;
+  // the changes at the present still count for GetEnergyDuration
+  Prune (std::lower_bound (m_niChanges.begin (), m_niChanges.end (), NiChange (Simulator::Now (), 0.0)));
+}
+} // namespace ns3
@@ -0,0 +1,425 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2005,2006 INRIA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
+ */
+#ifndef INTERFERENCE_HELPER_H
+#define INTERFERENCE_HELPER_H
+
+#include <stdint.h>
+#include <deque>
+#include <vector>
+#include <map>
+#include "wifi-mode.h"
+#include "wifi-preamble.h"
+#include "wifi-phy-standard.h"
+#include "ns3/nstime.h"
+#include "ns3/simple-ref-count.h"
+#include "ns3/wifi-tx-vector.h"
+#include "error-rate-model.h"
+
+namespace ns3 {
+
+class ErrorRateModel;
+
+/**
+ * \ingroup wifi
+ * \brief handles interference calculations
+ *
+ * The energy on the medium is kept as a time-ordered profile of the power
+ * changes, each one with the energy level it leads to. The past changes
+ * are folded into the first power as soon as no reception needs them, so
+ * the profile only holds the past of the current reception and one end
+ * per signal still on the air. As every signal starts at the time it is
+ * added, the energy never rises in the future, and the end of the energy
+ * above a threshold is found by a binary search.
+ */
+class InterferenceHelper
+{
+public:
+  /**
+   * Signal event for a packet.
+   */
+  class Event : public SimpleRefCount<InterferenceHelper::Event>
+  {
+public:
+    /**
+     * Create an Event with the given parameters.
+     *
+     * \param size packet size
+     * \param payloadMode Wi-Fi mode used for the payload
+     * \param preamble preamble type
+     * \param duration duration of the signal
+     * \param rxPower the receive power (w)
+     * \param txvector TXVECTOR of the packet
+     */
+    Event (uint32_t size, WifiMode payloadMode,
+           enum WifiPreamble preamble,
+           Time duration, double rxPower, WifiTxVector txvector);
+    ~Event ();
+
+    /**
+     * Return the duration of the signal.
+     *
+     * \return the duration of the signal
+     */
+    Time GetDuration (void) const;
+    /**
+     * Return the start time of the signal.
+     *
+     * \return the start time of the signal
+     */
+    Time GetStartTime (void) const;
+    /**
+     * Return the end time of the signal.
+     *
+     * \return the end time of the signal
+     */
+    Time GetEndTime (void) const;
+    /**
+     * Return the receive power (w).
+     *
+     * \return the receive power (w)
+     */
+    double GetRxPowerW (void) const;
+    /**
+     * Return the size of the packet (bytes).
+     *
+     * \return the size of the packet (bytes)
+     */
+    uint32_t GetSize (void) const;
+    /**
+     * Return the Wi-Fi mode used for the payload.
+     *
+     * \return the Wi-Fi mode used for the payload
+     */
+    WifiMode GetPayloadMode (void) const;
+    /**
+     * Return the preamble type of the packet.
+     *
+     * \return the preamble type of the packet
+     */
+    enum WifiPreamble GetPreambleType (void) const;
+    /**
+     * Return the TXVECTOR of the packet.
+     *
+     * \return the TXVECTOR of the packet
+     */
+    WifiTxVector GetTxVector (void) const;
+private:
+    uint32_t m_size;
+    WifiMode m_payloadMode;
+    enum WifiPreamble m_preamble;
+    Time m_startTime;
+    Time m_endTime;
+    double m_rxPowerW;
+    WifiTxVector m_txVector;
+  };
+  /**
+   * A struct for both SNR and PER
+   */
+  struct SnrPer
+  {
+    double snr;
+    double per;
+  };
+
+  InterferenceHelper ();
+  ~InterferenceHelper ();
+
+  /**
+   * Set the noise figure.
+   *
+   * \param value noise figure
+   */
+  void SetNoiseFigure (double value);
+  /**
+   * Set the error rate model for this interference helper.
+   *
+   * \param rate Error rate model
+   */
+  void SetErrorRateModel (Ptr<ErrorRateModel> rate);
+
+  /**
+   * Return the noise figure.
+   *
+   * \return the noise figure
+   */
+  double GetNoiseFigure (void) const;
+  /**
+   * Return the error rate model.
+   *
+   * \return Error rate model
+   */
+  Ptr<ErrorRateModel> GetErrorRateModel (void) const;
+  /**
+   * Return the noise floor of the receiver: the thermal noise over the
+   * bandwidth of the given mode, raised by the noise figure.
+   *
+   * \param mode the Wi-Fi mode giving the bandwidth
+   * \return the noise floor (w)
+   */
+  double GetNoiseFloorW (WifiMode mode) const;
+  /**
+   * Set the largest error of the chunk success rates read from the lookup
+   * tables, which replace the error rate model when positive.
+   *
+   * \param tolerance the largest error of a chunk success rate (0 disables the tables)
+   */
+  void SetPerTableTolerance (double tolerance);
+  /**
+   * Return the largest error of the chunk success rates read from the
+   * lookup tables.
+   *
+   * \return the largest error of a chunk success rate (0 when the tables are disabled)
+   */
+  double GetPerTableTolerance (void) const;
+
+
+  /**
+   * \param energyW the minimum energy (W) requested
+   * \returns the expected amount of time the observed
+   *          energy on the medium will be higher than
+   *          the requested threshold.
+   */
+  Time GetEnergyDuration (double energyW);
+
+
+  /**
+   * Add the packet-related signal to interference helper.
+   *
+   * \param size packet size
+   * \param payloadMode Wi-Fi mode for the payload
+   * \param preamble Wi-Fi preamble for the packet
+   * \param duration the duration of the signal
+   * \param rxPower receive power (w)
+   * \param txvector TXVECTOR of the packet
+   * \return InterferenceHelper::Event
+   */
+  Ptr<InterferenceHelper::Event> Add (uint32_t size, WifiMode payloadMode,
+                                      enum WifiPreamble preamble,
+                                      Time duration, double rxPower, WifiTxVector txvector);
+
+  /**
+   * Calculate the SNIR at the start of the packet and accumulate
+   * all SNIR changes in the snir vector.
+   *
+   * \param event the event corresponding to the first time the packet arrives
+   * \return struct of SNR and PER
+   */
+  struct InterferenceHelper::SnrPer CalculateSnrPer (Ptr<InterferenceHelper::Event> event);
+  /**
+   * Notify that RX has started.
+   */
+  void NotifyRxStart ();
+  /**
+   * Notify that RX has ended.
+   */
+  void NotifyRxEnd ();
+  /**
+   * Erase all events.
+   */
+  void EraseEvents (void);
+private:
+  /**
+   * Noise and Interference (thus Ni) event.
+   */
+  class NiChange
+  {
+public:
+    /**
+     * Create a NiChange at the given time and the amount of NI change.
+     *
+     * \param time time of the event
+     * \param delta the power
+     */
+    NiChange (Time time, double delta);
+    /**
+     * Return the event time.
+     *
+     * \return the event time.
+     */
+    Time GetTime (void) const;
+    /**
+     * Return the power
+     *
+     * \return the power
+     */
+    double GetDelta (void) const;
+    /**
+     * Return the energy on the medium once the change is applied.
+     *
+     * \return the energy (w) from the time of the change to the next one
+     */
+    double GetLevel (void) const;
+    /**
+     * Set the energy on the medium once the change is applied.
+     *
+     * \param level the energy (w)
+     */
+    void SetLevel (double level);
+    /**
+     * Compare the event time of two NiChange objects (a < o).
+     *
+     * \param o
+     * \return true if a < o.time, false otherwise
+     */
+    bool operator < (const NiChange& o) const;
+private:
+    Time m_time;
+    double m_delta;
+    double m_level;
+  };
+  /**
+   * typedef for a time-ordered sequence of NiChanges
+   */
+  typedef std::deque <NiChange> NiChanges;
+  /**
+   * Chunk success rates of a Wi-Fi mode, tabulated over the SNR and the
+   * number of bits of the chunk, and interpolated in between.
+   *
+   * The nodes are spaced evenly within each octave of SNR and of bits, so
+   * that a node is found with frexp rather than a logarithm. A cell whose
+   * interpolation, checked against the error rate model at the middle of
+   * the cell and of its edges, is off by more than half the tolerance is
+   * left to the model, as are the SNRs and chunk lengths out of the table.
+   */
+  class PerTable : public SimpleRefCount<PerTable>
+  {
+public:
+    /**
+     * Tabulate the chunk success rates of a mode.
+     *
+     * \param model the error rate model
+     * \param mode the Wi-Fi mode
+     * \param tolerance the largest error of an interpolated chunk success rate
+     */
+    PerTable (Ptr<ErrorRateModel> model, WifiMode mode, double tolerance);
+    /**
+     * \param model the error rate model, for the SNRs and lengths left to it
+     * \param snir SINR
+     * \param nbits the number of bits of the chunk
+     * \return the chunk success rate
+     */
+    double GetChunkSuccessRate (Ptr<ErrorRateModel> model, double snir, uint64_t nbits) const;
+private:
+    /**
+     * \param u the SNR coordinate of a node, or of a point between nodes
+     * \return the SNR (linear ratio)
+     */
+    static double GetSnr (double u);
+    /**
+     * \param v the length coordinate of a node, or of a point between nodes
+     * \return the number of bits
+     */
+    static uint32_t GetBits (double v);
+
+    WifiMode m_mode;
+    std::vector<double> m_csr;  //!< chunk success rate at the nodes, by SNR then length
+    std::vector<bool> m_exact;  //!< cells left to the error rate model, by SNR then length
+  };
+
+  InterferenceHelper (const InterferenceHelper &o);
+  InterferenceHelper &operator = (const InterferenceHelper &o);
+  /**
+   * Append the given Event.
+   *
+   * \param event
+   */
+  void AppendEvent (Ptr<Event> event);
+  /**
+   * Calculate noise and interference power in W.
+   *
+   * \param event
+   * \param ni
+   * \return noise and interference power
+   */
+  double CalculateNoiseInterferenceW (Ptr<Event> event, NiChanges *ni) const;
+  /**
+   * Calculate SNR (linear ratio) from the given signal power and noise+interference power.
+   * (Mode is not currently used)
+   *
+   * \param signal
+   * \param noiseInterference
+   * \param mode
+   * \return SNR in liear ratio
+   */
+  double CalculateSnr (double signal, double noiseInterference, WifiMode mode) const;
+  /**
+   * Calculate the success rate of the chunk given the SINR, duration, and Wi-Fi mode.
+   * The duration and mode are used to calculate how many bits are present in the chunk.
+   *
+   * \param snir SINR
+   * \param duration
+   * \param mode
+   * \return the success rate
+   */
+  double CalculateChunkSuccessRate (double snir, Time duration, WifiMode mode) const;
+  /**
+   * Calculate the error rate of the given packet. The packet can be divided into
+   * multiple chunks (e.g. due to interference from other transmissions).
+   *
+   * \param event
+   * \param ni
+   * \return the error rate of the packet
+   */
+  double CalculatePer (Ptr<const Event> event, NiChanges *ni) const;
+
+  /**
+   * Return the lookup table of a mode, shared by the helpers with the same
+   * type of error rate model and tolerance.
+   *
+   * \param mode
+   * \return the lookup table of the mode
+   */
+  Ptr<const PerTable> GetPerTable (WifiMode mode) const;
+
+  double m_noiseFigure; /**< noise figure (linear) */
+  Ptr<ErrorRateModel> m_errorRateModel;
+  double m_perTableTolerance; /**< largest error of a tabulated chunk success rate, 0 disables the tables */
+  mutable std::map<uint32_t, Ptr<const PerTable> > m_perTables; /**< lookup tables by mode uid */
+  /// Experimental: needed for energy duration calculation
+  NiChanges m_niChanges;
+  double m_firstPower;
+  bool m_rxing;
+  /// Returns an iterator to the first nichange, which is later than moment
+  NiChanges::iterator GetPosition (Time moment);
+  /**
+   * Add NiChange to the list at the appropriate position and update the
+   * energy levels of the later changes.
+   *
+   * \param change
+   */
+  void AddNiChangeEvent (NiChange change);
+  /**
+   * \param change
+   * \param energyW
+   * \return true if the energy after the change is at least energyW
+   */
+  static bool IsLevelAtLeast (const NiChange &change, double energyW);
+  /**
+   * Fold the changes before the given one into the first power, unless a
+   * reception still needs them.
+   *
+   * \param end the first change to keep
+   */
+  void Prune (NiChanges::iterator end);
+};
+
+} // namespace ns3
+
+#endif /* INTERFERENCE_HELPER_H */
@@ -5,14 +5,32 @@ route = '/home/nislab/xlx/ns-allinone-3.22-github/ns-3.22';
 
 for i = 1:49
     rho_0(i) = 0.02*i;
+    % written by --replications=K: per node mean, variance and 95% half-width of utilization and throughput
+    summary_file = sprintf('%s/CDoS-1Mbps-adhoc-UDP-01/u_0=%0.2frho=0.13R=7T=1500/summary.txt', route, rho_0(i));
+    if exist(summary_file, 'file')
+        summary = load(summary_file);
+        for j = 1:41
+            node_id = 82 - j*2;
+            utilization(i,j) = summary(node_id+1,2);
+            utilization_ci(i,j) = summary(node_id+1,4);
+            throughput(i,j) = summary(node_id+2,5);
+            throughput_ci(i,j) = summary(node_id+2,7);
+        end
+        continue;
+    end
     for j = 1:41
         node_id = 82 - j*2;
         data = load(sprintf('%s/CDoS-1Mbps-adhoc-UDP-01/u_0=%0.2frho=0.13R=7T=1500/nodes_%03d_000'...
             ,route, rho_0(i), node_id));
-        utilization(i,j) = mean(data(150:end,9));
+        % rows of the initial transient, as detected by the MSER rule of the trace sink
+        warmup = load(sprintf('%s/CDoS-1Mbps-adhoc-UDP-01/u_0=%0.2frho=0.13R=7T=1500/nodes_%03d_000.warmup'...
+            ,route, rho_0(i), node_id));
+        utilization(i,j) = mean(data(warmup(1)+1:end,9));
         data = load(sprintf('%s/CDoS-1Mbps-adhoc-UDP-01/u_0=%0.2frho=0.13R=7T=1500/nodes_%03d_000'...
             ,route, rho_0(i), node_id+1));
-        throughput(i,j) = mean(data(150:end,2));
+        throughput(i,j) = mean(data(warmup(1)+1:end,2));
+        utilization_ci(i,j) = 0;
+        throughput_ci(i,j) = 0;
     end
 end
 
@@ -20,9 +38,9 @@ figure(1);
 %plot(mean(PhyTx0,2)/62.5, mean(PhyTx1,2)/62.5, 'LineStyle', '-', 'Color', 'r','linewidth',6);
 %plot(0.02:0.02:0.98, utilization(1,:), 'LineStyle', '-', 'Color', 'r','linewidth',6);
 %hold on;
-plot(rho_0, utilization(:,20),'LineStyle', '-', 'Color', 'g','linewidth',6);
+errorbar(rho_0, utilization(:,20), utilization_ci(:,20),'LineStyle', '-', 'Color', 'g','linewidth',6);
 hold on;
-plot(rho_0, utilization(:,40),'LineStyle', ':', 'Color', 'b','linewidth',6);
+errorbar(rho_0, utilization(:,40), utilization_ci(:,40),'LineStyle', ':', 'Color', 'b','linewidth',6);
 hold on;
 grid on;
 xlabel('Load at node $A_0$','FontSize',20,'interpreter','latex');
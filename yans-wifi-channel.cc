@@ -0,0 +1,365 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2006,2007 INRIA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Mathieu Lacage, <mathieu.lacage@sophia.inria.fr>
+ */
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/mobility-model.h"
+#include "ns3/net-device.h"
+#include "ns3/node.h"
+#include "ns3/log.h"
+#include "ns3/pointer.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
+#include "ns3/object-factory.h"
+#include "yans-wifi-channel.h"
+#include "yans-wifi-phy.h"
+#include "ns3/propagation-loss-model.h"
+#include "ns3/propagation-delay-model.h"
+#include <cmath>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("YansWifiChannel");
+
+NS_OBJECT_ENSURE_REGISTERED (YansWifiChannel);
+
+TypeId
+YansWifiChannel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::YansWifiChannel")
+    .SetParent<WifiChannel> ()
+    .AddConstructor<YansWifiChannel> ()
+    .AddAttribute ("PropagationLossModel", "A pointer to the propagation loss model attached to this channel.",
+                   PointerValue (),
+                   MakePointerAccessor (&YansWifiChannel::m_loss),
+                   MakePointerChecker<PropagationLossModel> ())
+    .AddAttribute ("PropagationDelayModel", "A pointer to the propagation delay model attached to this channel.",
+                   PointerValue (),
+                   MakePointerAccessor (&YansWifiChannel::m_delay),
+                   MakePointerChecker<PropagationDelayModel> ())
+    .AddAttribute ("NeighbourLists",
+                   "Deliver each frame only to the PHYs whose received power reaches NeighbourThreshold. "
+                   "The neighbours of a sender are computed once, which requires a deterministic loss model.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&YansWifiChannel::m_neighbourLists),
+                   MakeBooleanChecker ())
+    .AddAttribute ("NeighbourThreshold",
+                   "The received power (dBm), rx gain included, from which a PHY is a neighbour of a sender.",
+                   DoubleValue (-110.0),
+                   MakeDoubleAccessor (&YansWifiChannel::m_neighbourThreshold),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("LinkCache",
+                   "Compute the delay and the received power of each link once per tx power. "
+                   "This requires deterministic loss and delay models.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&YansWifiChannel::m_linkCache),
+                   MakeBooleanChecker ())
+  ;
+  return tid;
+}
+
+YansWifiChannel::YansWifiChannel ()
+  : m_neighbourLists (false),
+    m_neighbourThreshold (-110.0),
+    m_watchedMobility (0),
+    m_skippedReceptions (0),
+    m_linkCache (false)
+{
+}
+YansWifiChannel::~YansWifiChannel ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  m_phyList.clear ();
+  m_phyIndex.clear ();
+}
+
+void
+YansWifiChannel::SetPropagationLossModel (Ptr<PropagationLossModel> loss)
+{
+  m_loss = loss;
+  InvalidateLinks ();
+}
+void
+YansWifiChannel::SetPropagationDelayModel (Ptr<PropagationDelayModel> delay)
+{
+  m_delay = delay;
+  InvalidateLinks ();
+}
+
+void
+YansWifiChannel::Send (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, double txPowerDbm,
+                       WifiTxVector txVector, WifiPreamble preamble, uint8_t packetType, Time duration) const
+{
+  Ptr<MobilityModel> senderMobility = sender->GetMobility ()->GetObject<MobilityModel> ();
+  NS_ASSERT (senderMobility != 0);
+  if (m_neighbourLists || m_linkCache)
+    {
+      std::map<Ptr<YansWifiPhy>, uint32_t>::const_iterator it = m_phyIndex.find (sender);
+      NS_ASSERT (it != m_phyIndex.end ());
+      uint32_t i = it->second;
+      if (m_neighbourLists && (!m_neighboursValid[i] || txPowerDbm > m_neighbourTxPowerDbm[i]))
+        {
+          UpdateNeighbours (i, senderMobility, txPowerDbm);
+        }
+      Link const *links = 0;
+      if (m_linkCache)
+        {
+          LinkRow const &row = GetLinks (i, senderMobility, txPowerDbm);
+          links = row.links.empty () ? 0 : &row.links[0];
+        }
+      if (m_neighbourLists)
+        {
+          std::vector<uint32_t> const &neighbours = m_neighbours[i];
+          m_skippedReceptions += m_phyList.size () - 1 - neighbours.size ();
+          for (uint32_t k = 0; k < neighbours.size (); k++)
+            {
+              Deliver (sender, senderMobility, neighbours[k], links != 0 ? links + k : 0,
+                       packet, txPowerDbm, txVector, preamble, packetType, duration);
+            }
+          return;
+        }
+      for (uint32_t j = 0; j < m_phyList.size (); j++)
+        {
+          if (j != i)
+            {
+              Deliver (sender, senderMobility, j, links + j, packet, txPowerDbm, txVector, preamble, packetType, duration);
+            }
+        }
+      return;
+    }
+  for (uint32_t j = 0; j < m_phyList.size (); j++)
+    {
+      if (sender != m_phyList[j])
+        {
+          Deliver (sender, senderMobility, j, 0, packet, txPowerDbm, txVector, preamble, packetType, duration);
+        }
+    }
+}
+
+void
+YansWifiChannel::Deliver (Ptr<YansWifiPhy> sender, Ptr<MobilityModel> senderMobility, uint32_t j, Link const *link,
+                          Ptr<const Packet> packet, double txPowerDbm, WifiTxVector txVector,
+                          WifiPreamble preamble, uint8_t packetType, Time duration) const
+{
+  // For now don't account for inter channel interference
+  if (m_phyList[j]->GetChannelNumber () != sender->GetChannelNumber ())
+    {
+      return;
+    }
+
+  Ptr<MobilityModel> receiverMobility = m_phyList[j]->GetMobility ()->GetObject<MobilityModel> ();
+  Time delay;
+  double rxPowerDbm;
+  if (link != 0)
+    {
+      delay = link->delay;
+      rxPowerDbm = link->rxPowerDbm;
+    }
+  else
+    {
+      delay = m_delay->GetDelay (senderMobility, receiverMobility);
+      rxPowerDbm = m_loss->CalcRxPower (txPowerDbm, senderMobility, receiverMobility);
+    }
+  NS_LOG_DEBUG ("propagation: txPower=" << txPowerDbm << "dbm, rxPower=" << rxPowerDbm << "dbm, " <<
+                "distance=" << senderMobility->GetDistanceFrom (receiverMobility) << "m, delay=" << delay);
+  Ptr<Packet> copy = packet->Copy ();
+  Ptr<Object> dstNetDevice = m_phyList[j]->GetDevice ();
+  uint32_t dstNode;
+  if (dstNetDevice == 0)
+    {
+      dstNode = 0xffffffff;
+    }
+  else
+    {
+      dstNode = dstNetDevice->GetObject<NetDevice> ()->GetNode ()->GetId ();
+    }
+
+  double *atts = new double[3];
+  *atts = rxPowerDbm;
+  *(atts+1)= packetType;
+  *(atts+2)= duration.GetNanoSeconds();
+
+  if (link != 0)
+    {
+      *atts = link->rxPowerW;
+      Simulator::ScheduleWithContext (dstNode,
+                                      delay, &YansWifiChannel::ReceiveW, this,
+                                      j, copy, atts, txVector, preamble);
+      return;
+    }
+  Simulator::ScheduleWithContext (dstNode,
+                                  delay, &YansWifiChannel::Receive, this,
+                                  j, copy, atts, txVector, preamble);
+}
+
+void
+YansWifiChannel::UpdateNeighbours (uint32_t i, Ptr<MobilityModel> senderMobility, double txPowerDbm) const
+{
+  NS_LOG_FUNCTION (this << i << txPowerDbm);
+  WatchMobility ();
+  std::vector<uint32_t> &neighbours = m_neighbours[i];
+  neighbours.clear ();
+  for (uint32_t j = 0; j < m_phyList.size (); j++)
+    {
+      if (j == i)
+        {
+          continue;
+        }
+      Ptr<MobilityModel> receiverMobility = m_phyList[j]->GetMobility ()->GetObject<MobilityModel> ();
+      double rxPowerDbm = m_loss->CalcRxPower (txPowerDbm, senderMobility, receiverMobility) + m_phyList[j]->GetRxGain ();
+      if (rxPowerDbm >= m_neighbourThreshold)
+        {
+          neighbours.push_back (j);
+        }
+    }
+  m_neighbourTxPowerDbm[i] = txPowerDbm;
+  m_neighboursValid[i] = true;
+  // the cached links of the sender follow its neighbour list
+  m_links[i].clear ();
+  NS_LOG_DEBUG ("phy " << i << " has " << neighbours.size () << " neighbours of " << m_phyList.size () - 1);
+}
+
+YansWifiChannel::LinkRow const &
+YansWifiChannel::GetLinks (uint32_t i, Ptr<MobilityModel> senderMobility, double txPowerDbm) const
+{
+  std::vector<LinkRow> &rows = m_links[i];
+  for (std::vector<LinkRow>::const_iterator row = rows.begin (); row != rows.end (); row++)
+    {
+      if (row->txPowerDbm == txPowerDbm)
+        {
+          return *row;
+        }
+    }
+  NS_LOG_FUNCTION (this << i << txPowerDbm);
+  WatchMobility ();
+  std::vector<uint32_t> receivers;
+  if (m_neighbourLists)
+    {
+      receivers = m_neighbours[i];
+    }
+  else
+    {
+      for (uint32_t j = 0; j < m_phyList.size (); j++)
+        {
+          receivers.push_back (j);
+        }
+    }
+  rows.push_back (LinkRow ());
+  LinkRow &row = rows.back ();
+  row.txPowerDbm = txPowerDbm;
+  row.links.resize (receivers.size ());
+  for (uint32_t k = 0; k < receivers.size (); k++)
+    {
+      uint32_t j = receivers[k];
+      if (j == i)
+        {
+          continue;
+        }
+      Ptr<MobilityModel> receiverMobility = m_phyList[j]->GetMobility ()->GetObject<MobilityModel> ();
+      Link &link = row.links[k];
+      link.delay = m_delay->GetDelay (senderMobility, receiverMobility);
+      link.rxPowerDbm = m_loss->CalcRxPower (txPowerDbm, senderMobility, receiverMobility);
+      // as YansWifiPhy::DbmToW
+      link.rxPowerW = std::pow (10.0, (link.rxPowerDbm + m_phyList[j]->GetRxGain ()) / 10.0) / 1000.0;
+    }
+  return row;
+}
+
+void
+YansWifiChannel::WatchMobility (void) const
+{
+  for (; m_watchedMobility < m_phyList.size (); m_watchedMobility++)
+    {
+      Ptr<MobilityModel> mobility = m_phyList[m_watchedMobility]->GetMobility ()->GetObject<MobilityModel> ();
+      mobility->TraceConnectWithoutContext ("CourseChange", MakeCallback (&YansWifiChannel::NotifyCourseChange, this));
+    }
+}
+
+void
+YansWifiChannel::InvalidateLinks (void) const
+{
+  m_neighboursValid.assign (m_phyList.size (), false);
+  m_links.assign (m_phyList.size (), std::vector<LinkRow> ());
+}
+
+void
+YansWifiChannel::NotifyCourseChange (Ptr<const MobilityModel> mobility) const
+{
+  NS_LOG_FUNCTION (this << mobility);
+  InvalidateLinks ();
+}
+
+void
+YansWifiChannel::Receive (uint32_t i, Ptr<Packet> packet, double *atts,
+                          WifiTxVector txVector, WifiPreamble preamble) const
+{
+  m_phyList[i]->StartReceivePacket (packet, *atts, txVector, preamble,*(atts+1), NanoSeconds(*(atts+2)));
+  delete[] atts;
+}
+
+void
+YansWifiChannel::ReceiveW (uint32_t i, Ptr<Packet> packet, double *atts,
+                           WifiTxVector txVector, WifiPreamble preamble) const
+{
+  m_phyList[i]->StartReceivePacketW (packet, *atts, txVector, preamble,*(atts+1), NanoSeconds(*(atts+2)));
+  delete[] atts;
+}
+
+uint32_t
+YansWifiChannel::GetNDevices (void) const
+{
+  return m_phyList.size ();
+}
+Ptr<NetDevice>
+YansWifiChannel::GetDevice (uint32_t i) const
+{
+  return m_phyList[i]->GetDevice ()->GetObject<NetDevice> ();
+}
+
+void
+YansWifiChannel::Add (Ptr<YansWifiPhy> phy)
+{
+  m_phyIndex[phy] = m_phyList.size ();
+  m_phyList.push_back (phy);
+  m_neighbours.resize (m_phyList.size ());
+  m_neighbourTxPowerDbm.resize (m_phyList.size ());
+  InvalidateLinks ();
+}
+
+int64_t
+YansWifiChannel::AssignStreams (int64_t stream)
+{
+  int64_t currentStream = stream;
+  currentStream += m_loss->AssignStreams (stream);
+  return (currentStream - stream);
+}
+
+uint64_t
+YansWifiChannel::GetNSkippedReceptions (void) const
+{
+  return m_skippedReceptions;
+}
+
+void
+YansWifiChannel::NotifyRxGainChange (void)
+{
+  InvalidateLinks ();
+}
+
+} // namespace ns3
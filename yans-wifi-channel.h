@@ -0,0 +1,260 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2006,2007 INRIA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Mathieu Lacage, <mathieu.lacage@sophia.inria.fr>
+ */
+#ifndef YANS_WIFI_CHANNEL_H
+#define YANS_WIFI_CHANNEL_H
+
+#include <vector>
+#include <map>
+#include <stdint.h>
+#include "ns3/packet.h"
+#include "wifi-channel.h"
+#include "wifi-mode.h"
+#include "wifi-preamble.h"
+#include "wifi-tx-vector.h"
+#include "ns3/nstime.h"
+
+namespace ns3 {
+
+class NetDevice;
+class PropagationLossModel;
+class PropagationDelayModel;
+class MobilityModel;
+class YansWifiPhy;
+
+/**
+ * \brief A Yans wifi channel
+ * \ingroup wifi
+ *
+ * This wifi channel implements the propagation model described in
+ * "Yet Another Network Simulator", (http://cutebugs.net/files/wns2-yans.pdf).
+ *
+ * This class is expected to be used in tandem with the ns3::YansWifiPhy
+ * class and contains a ns3::PropagationLossModel and a ns3::PropagationDelayModel.
+ * By default, no propagation models are set so, it is the caller's responsability
+ * to set them before using the channel.
+ *
+ * With the NeighbourLists attribute, a frame is only delivered to the
+ * neighbours of its sender: the PHYs whose received power, including their
+ * rx gain, reaches NeighbourThreshold. The neighbours of a sender are
+ * computed at its first transmission, or again when it transmits with a
+ * higher power, so the loss model must be deterministic. The lists are
+ * dropped when a mobility model reports a course change, a PHY is added or
+ * the loss model is replaced; a loss model modified in place must be set
+ * again.
+ *
+ * With the LinkCache attribute, the delay and the received power, in dBm and
+ * in Watts with the rx gain of the receiver, of every link of a sender are
+ * computed once per tx power, so both models must be deterministic. The
+ * cache is dropped on the same events as the neighbour lists, when the
+ * delay model is replaced, and when the rx gain of a PHY changes.
+ */
+class YansWifiChannel : public WifiChannel
+{
+public:
+  static TypeId GetTypeId (void);
+
+  YansWifiChannel ();
+  virtual ~YansWifiChannel ();
+
+  // inherited from Channel.
+  virtual uint32_t GetNDevices (void) const;
+  virtual Ptr<NetDevice> GetDevice (uint32_t i) const;
+
+  /**
+   * Adds the given YansWifiPhy to the PHY list
+   *
+   * \param phy the YansWifiPhy to be added to the PHY list
+   */
+  void Add (Ptr<YansWifiPhy> phy);
+
+  /**
+   * \param loss the new propagation loss model.
+   */
+  void SetPropagationLossModel (Ptr<PropagationLossModel> loss);
+  /**
+   * \param delay the new propagation delay model.
+   */
+  void SetPropagationDelayModel (Ptr<PropagationDelayModel> delay);
+
+  /**
+   * \param sender the device from which the packet is originating.
+   * \param packet the packet to send
+   * \param txPowerDbm the tx power associated to the packet
+   * \param txVector the TXVECTOR associated to the packet
+   * \param preamble the preamble associated to the packet
+   * \param packetType The type of the packet, used for A-MPDU to say whether it's the last MPDU or not
+   * \param duration the transmission duration associated to the packet
+   *
+   * This method should not be invoked by normal users. It is
+   * currently invoked only from WifiPhy::Send. YansWifiChannel
+   * delivers packets only between PHYs with the same m_channelNumber,
+   * e.g. PHYs that are operating on the same channel.
+   */
+  void Send (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, double txPowerDbm,
+             WifiTxVector txVector, WifiPreamble preamble, uint8_t packetType, Time duration) const;
+
+  /**
+   * Assign a fixed random variable stream number to the random variables
+   * used by this model.  Return the number of streams (possibly zero) that
+   * have been assigned.
+   *
+   * \param stream first stream index to use
+   * \return the number of stream indices assigned by this model
+   */
+  int64_t AssignStreams (int64_t stream);
+
+  /**
+   * \return the number of receptions skipped because the receiver was not
+   * a neighbour of the sender
+   */
+  uint64_t GetNSkippedReceptions (void) const;
+
+  /**
+   * Drop the link cache. This method is invoked by YansWifiPhy::SetRxGain.
+   */
+  void NotifyRxGainChange (void);
+
+private:
+  YansWifiChannel& operator = (const YansWifiChannel &);
+  YansWifiChannel (const YansWifiChannel &);
+
+  /**
+   * A vector of pointers to YansWifiPhy.
+   */
+  typedef std::vector<Ptr<YansWifiPhy> > PhyList;
+  /**
+   * The propagation from a sender to a receiver, for one tx power.
+   */
+  struct Link
+  {
+    double rxPowerDbm; //!< Received power (dBm), rx gain excluded
+    double rxPowerW;   //!< Received power (W), rx gain included
+    Time delay;        //!< Propagation delay
+  };
+  /**
+   * The links of a sender to the receivers it delivers to, for one tx power.
+   */
+  struct LinkRow
+  {
+    double txPowerDbm;        //!< Tx power of the links
+    std::vector<Link> links;  //!< Links, indexed by PHY, or by neighbour with the neighbour lists
+  };
+  /**
+   * This method is scheduled by Send for each associated YansWifiPhy.
+   * The method then calls the corresponding YansWifiPhy that the first
+   * bit of the packet has arrived.
+   *
+   * \param i index of the corresponding YansWifiPhy in the PHY list
+   * \param packet the packet being sent
+   * \param atts a vector containing the received power in dBm and the packet type
+   * \param txVector the TXVECTOR of the packet
+   * \param preamble the type of preamble being used to send the packet
+   */
+  void Receive (uint32_t i, Ptr<Packet> packet, double *atts,
+                WifiTxVector txVector, WifiPreamble preamble) const;
+  /**
+   * Same as Receive, with the received power of the link cache.
+   *
+   * \param i index of the corresponding YansWifiPhy in the PHY list
+   * \param packet the packet being sent
+   * \param atts a vector containing the received power in W, rx gain included, and the packet type
+   * \param txVector the TXVECTOR of the packet
+   * \param preamble the type of preamble being used to send the packet
+   */
+  void ReceiveW (uint32_t i, Ptr<Packet> packet, double *atts,
+                 WifiTxVector txVector, WifiPreamble preamble) const;
+
+  /**
+   * Schedule the reception of a packet by the PHY of index j.
+   *
+   * \param sender the device from which the packet is originating
+   * \param senderMobility the mobility model of the sender
+   * \param j index of the receiving YansWifiPhy in the PHY list
+   * \param link the cached link to the receiver, or 0 to compute it
+   * \param packet the packet to send
+   * \param txPowerDbm the tx power associated to the packet
+   * \param txVector the TXVECTOR associated to the packet
+   * \param preamble the preamble associated to the packet
+   * \param packetType the type of the packet
+   * \param duration the transmission duration associated to the packet
+   */
+  void Deliver (Ptr<YansWifiPhy> sender, Ptr<MobilityModel> senderMobility, uint32_t j, Link const *link,
+                Ptr<const Packet> packet, double txPowerDbm, WifiTxVector txVector,
+                WifiPreamble preamble, uint8_t packetType, Time duration) const;
+
+  /**
+   * Compute the neighbours of a sender for a tx power.
+   *
+   * \param i index of the sender in the PHY list
+   * \param senderMobility the mobility model of the sender
+   * \param txPowerDbm the tx power
+   */
+  void UpdateNeighbours (uint32_t i, Ptr<MobilityModel> senderMobility, double txPowerDbm) const;
+
+  /**
+   * Return the cached links of a sender for a tx power, computing them if
+   * needed.
+   *
+   * \param i index of the sender in the PHY list
+   * \param senderMobility the mobility model of the sender
+   * \param txPowerDbm the tx power
+   * \return the links to every PHY, or to the neighbours with the neighbour lists
+   */
+  LinkRow const & GetLinks (uint32_t i, Ptr<MobilityModel> senderMobility, double txPowerDbm) const;
+
+  /**
+   * Connect the CourseChange trace of the mobility models of the PHYs
+   * added since the last call.
+   */
+  void WatchMobility (void) const;
+
+  /**
+   * Drop the neighbour lists and the link cache, which are computed again
+   * at the next transmission of each sender.
+   */
+  void InvalidateLinks (void) const;
+
+  /**
+   * Trace sink of the CourseChange of the mobility models of the PHYs.
+   *
+   * \param mobility the mobility model whose course changed
+   */
+  void NotifyCourseChange (Ptr<const MobilityModel> mobility) const;
+
+
+  PhyList m_phyList; //!< List of YansWifiPhys connected to this YansWifiChannel
+  Ptr<PropagationLossModel> m_loss; //!< Propagation loss model
+  Ptr<PropagationDelayModel> m_delay; //!< Propagation delay model
+
+  bool m_neighbourLists;                    //!< Whether frames are only delivered to the neighbours of the sender
+  double m_neighbourThreshold;              //!< Received power of a neighbour (dBm)
+  std::map<Ptr<YansWifiPhy>, uint32_t> m_phyIndex; //!< Index of each PHY in the PHY list
+  mutable std::vector<std::vector<uint32_t> > m_neighbours; //!< Neighbours of each sender
+  mutable std::vector<double> m_neighbourTxPowerDbm;        //!< Tx power the neighbours of each sender were computed for
+  mutable std::vector<bool> m_neighboursValid;              //!< Whether the neighbours of each sender are up to date
+  mutable uint32_t m_watchedMobility;       //!< Number of leading PHYs whose course changes are traced
+  mutable uint64_t m_skippedReceptions;     //!< Receptions skipped by the neighbour lists
+  bool m_linkCache;                         //!< Whether the links of each sender are cached
+  mutable std::vector<std::vector<LinkRow> > m_links; //!< Cached links of each sender, one row per tx power
+};
+
+} // namespace ns3
+
+#endif /* YANS_WIFI_CHANNEL_H */
@@ -65,6 +65,20 @@ YansWifiPhy::GetTypeId (void)
                    MakeDoubleAccessor (&YansWifiPhy::SetCcaMode1Threshold,
                                        &YansWifiPhy::GetCcaMode1Threshold),
                    MakeDoubleChecker<double> ())
+    .AddAttribute ("CullingThreshold",
+                   "A received signal this many dB below the noise floor of its mode is ignored "
+                   "altogether (0 disables culling).",
+                   DoubleValue (0.0),
+                   MakeDoubleAccessor (&YansWifiPhy::SetCullingThreshold,
+                                       &YansWifiPhy::GetCullingThreshold),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("PerTableTolerance",
+                   "Read the chunk success rates from lookup tables, interpolated to within this "
+                   "error of the error rate model (0 evaluates the model for every chunk).",
+                   DoubleValue (0.0),
+                   MakeDoubleAccessor (&YansWifiPhy::SetPerTableTolerance,
+                                       &YansWifiPhy::GetPerTableTolerance),
+                   MakeDoubleChecker<double> (0.0, 1.0))
     .AddAttribute ("TxGain",
                    "Transmission gain (dB).",
                    DoubleValue (1.0),
@@ -174,6 +188,10 @@ YansWifiPhy::GetTypeId (void)
 
 YansWifiPhy::YansWifiPhy ()
   :  m_initialized (false),
+    m_cullingThresholdDb (0.0),
+    m_cullingRatio (0.0),
+    m_culledSignals (0),
+    m_maxCulledRatio (0.0),
     m_channelNumber (1),
     m_endRxEvent (),
     m_channelStartingFrequency (0),
@@ -283,6 +301,10 @@ YansWifiPhy::SetRxGain (double gain)
 {
   NS_LOG_FUNCTION (this << gain);
   m_rxGainDb = gain;
+  if (m_channel != 0)
+    {
+      m_channel->NotifyRxGainChange ();
+    }
 }
 void
 YansWifiPhy::SetEdThreshold (double threshold)
@@ -297,6 +319,19 @@ YansWifiPhy::SetCcaMode1Threshold (double threshold)
   m_ccaMode1ThresholdW = DbmToW (threshold);
 }
 void
+YansWifiPhy::SetPerTableTolerance (double tolerance)
+{
+  NS_LOG_FUNCTION (this << tolerance);
+  m_interference.SetPerTableTolerance (tolerance);
+}
+void
+YansWifiPhy::SetCullingThreshold (double threshold)
+{
+  NS_LOG_FUNCTION (this << threshold);
+  m_cullingThresholdDb = threshold;
+  m_cullingRatio = threshold > 0 ? DbToRatio (-threshold) : 0.0;
+}
+void
 YansWifiPhy::SetErrorRateModel (Ptr<ErrorRateModel> rate)
 {
   m_interference.SetErrorRateModel (rate);
@@ -337,6 +372,33 @@ YansWifiPhy::GetRxGain (void) const
 {
   return m_rxGainDb;
 }
+double
+YansWifiPhy::GetCullingThreshold (void) const
+{
+  return m_cullingThresholdDb;
+}
+double
+YansWifiPhy::GetPerTableTolerance (void) const
+{
+  return m_interference.GetPerTableTolerance ();
+}
+uint64_t
+YansWifiPhy::GetNCulledSignals (void) const
+{
+  return m_culledSignals;
+}
+double
+YansWifiPhy::GetCullingErrorBound (void) const
+{
+  return RatioToDb (1.0 + m_maxCulledRatio);
+}
+void
+YansWifiPhy::ResetCulling (void)
+{
+  m_culledSignals = 0;
+  m_maxCulledRatio = 0.0;
+  m_culled.clear ();
+}
 
 double
 YansWifiPhy::GetEdThreshold (void) const
@@ -533,12 +595,33 @@ YansWifiPhy::StartReceivePacket (Ptr<Packet> packet,
                                  uint8_t packetType, Time rxDuration)
 {
   NS_LOG_FUNCTION (this << packet << rxPowerDbm << txVector.GetMode()<< preamble << (uint32_t)packetType);
-  AmpduTag ampduTag;
   rxPowerDbm += m_rxGainDb;
-  double rxPowerW = DbmToW (rxPowerDbm);
+  StartReceivePacketW (packet, DbmToW (rxPowerDbm), txVector, preamble, packetType, rxDuration);
+}
+
+void
+YansWifiPhy::StartReceivePacketW (Ptr<Packet> packet,
+                                  double rxPowerW,
+                                  WifiTxVector txVector,
+                                  enum WifiPreamble preamble,
+                                  uint8_t packetType, Time rxDuration)
+{
+  NS_LOG_FUNCTION (this << packet << rxPowerW << txVector.GetMode()<< preamble << (uint32_t)packetType);
+  AmpduTag ampduTag;
   WifiMode txMode = txVector.GetMode();
   Time endRx = Simulator::Now () + rxDuration;
 
+  if (m_cullingRatio > 0)
+    {
+      double noiseFloorW = m_interference.GetNoiseFloorW (txMode);
+      if (rxPowerW < noiseFloorW * m_cullingRatio)
+        {
+          NS_LOG_DEBUG ("cull signal (power=" << rxPowerW << "W)");
+          CullSignal (rxPowerW / noiseFloorW, rxDuration);
+          return;
+        }
+    }
+
   Ptr<InterferenceHelper::Event> event;
   event = m_interference.Add (packet->GetSize (),
                               txMode,
@@ -668,6 +751,31 @@ maybeCcaBusy:
     }
 }
 
+void
+YansWifiPhy::CullSignal (double ratio, Time rxDuration)
+{
+  m_culledSignals++;
+  Time now = Simulator::Now ();
+  double sum = ratio;
+  for (std::vector<std::pair<Time, double> >::iterator i = m_culled.begin (); i != m_culled.end (); )
+    {
+      if (i->first <= now)
+        {
+          i = m_culled.erase (i);
+        }
+      else
+        {
+          sum += i->second;
+          i++;
+        }
+    }
+  m_culled.push_back (std::make_pair (now + rxDuration, ratio));
+  if (sum > m_maxCulledRatio)
+    {
+      m_maxCulledRatio = sum;
+    }
+}
+
 void
 YansWifiPhy::SendPacket (Ptr<const Packet> packet, WifiTxVector txVector, WifiPreamble preamble, uint8_t packetType)
 {
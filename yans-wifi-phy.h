@@ -23,6 +23,8 @@
 #define YANS_WIFI_PHY_H
 
 #include <stdint.h>
+#include <vector>
+#include <utility>
 #include "ns3/callback.h"
 #include "ns3/event-id.h"
 #include "ns3/packet.h"
@@ -115,6 +117,24 @@ public:
                            WifiPreamble preamble,
                            uint8_t packetType,
                            Time rxDuration);
+  /**
+   * Starting receiving the packet, whose receive power has already been
+   * converted to Watts with the reception gain, e.g. by the link cache of
+   * YansWifiChannel.
+   *
+   * \param packet the arriving packet
+   * \param rxPowerW the receive power in W, reception gain included
+   * \param txVector the TXVECTOR of the arriving packet
+   * \param preamble the preamble of the arriving packet
+   * \param packetType the type of the received packet
+   * \param rxDuration the duration needed for the reception of the arriving packet
+   */
+  void StartReceivePacketW (Ptr<Packet> packet,
+                            double rxPowerW,
+                            WifiTxVector txVector,
+                            WifiPreamble preamble,
+                            uint8_t packetType,
+                            Time rxDuration);
 
 	typedef Callback<void, Ptr<Packet>, Time> TxDurationCallback;
 
@@ -175,6 +195,23 @@ public:
    * \param threshold the CCA threshold in dBm
    */
   void SetCcaMode1Threshold (double threshold);
+  /**
+   * Sets the culling threshold (dB below the noise floor). A signal
+   * received this much below the noise floor of its mode is ignored
+   * altogether: it neither adds interference nor is traced as dropped.
+   * Zero disables culling.
+   *
+   * \param threshold the culling threshold in dB below the noise floor
+   */
+  void SetCullingThreshold (double threshold);
+  /**
+   * Sets the largest error of the chunk success rates read from the PER
+   * lookup tables of the InterferenceHelper, which replace the error rate
+   * model when positive.
+   *
+   * \param tolerance the largest error of a chunk success rate (0 disables the tables)
+   */
+  void SetPerTableTolerance (double tolerance);
   /**
    * Sets the error rate model.
    *
@@ -223,6 +260,37 @@ public:
    * \return the CCA threshold in dBm
    */
   double GetCcaMode1Threshold (void) const;
+  /**
+   * Return the culling threshold (dB below the noise floor).
+   *
+   * \return the culling threshold in dB below the noise floor
+   */
+  double GetCullingThreshold (void) const;
+  /**
+   * Return the largest error of the chunk success rates read from the PER
+   * lookup tables.
+   *
+   * \return the largest error of a chunk success rate (0 when the tables are disabled)
+   */
+  double GetPerTableTolerance (void) const;
+  /**
+   * \return the number of signals culled since the last ResetCulling
+   */
+  uint64_t GetNCulledSignals (void) const;
+  /**
+   * Return the largest error (dB) the culling could have caused on the
+   * SINR of a reception since the last ResetCulling: the ratio of the
+   * noise floor plus the culled signals on the air at the same time to
+   * the noise floor alone. The energy sensed by CCA is short of the same
+   * culled power at most.
+   *
+   * \return the worst-case SINR overestimate in dB
+   */
+  double GetCullingErrorBound (void) const;
+  /**
+   * Reset the culling counters.
+   */
+  void ResetCulling (void);
   /**
    * Return the error rate model this PHY is using.
    *
@@ -475,10 +543,22 @@ private:
 
 private:
   virtual void DoInitialize (void);
+  /**
+   * Count a culled signal and the culled power on the air with it.
+   *
+   * \param ratio the received power of the signal relative to the noise floor
+   * \param rxDuration the duration of the signal
+   */
+  void CullSignal (double ratio, Time rxDuration);
 
   bool     m_initialized;         //!< Flag for runtime initialization
   double   m_edThresholdW;        //!< Energy detection threshold in watts
   double   m_ccaMode1ThresholdW;  //!< Clear channel assessment (CCA) threshold in watts
+  double   m_cullingThresholdDb;  //!< Culling threshold (dB below the noise floor)
+  double   m_cullingRatio;        //!< Culling threshold as a ratio to the noise floor, 0 when disabled
+  uint64_t m_culledSignals;       //!< Number of signals culled
+  double   m_maxCulledRatio;      //!< Largest culled power on the air at once, relative to the noise floor
+  std::vector<std::pair<Time, double> > m_culled; //!< End and relative power of the culled signals on the air
   double   m_txGainDb;            //!< Transmission gain (dB)
   double   m_rxGainDb;            //!< Reception gain (dB)
   double   m_txPowerBaseDbm;      //!< Minimum transmission power (dBm)